@@ -1,6 +1,8 @@
 #include "Manager.h"
 #include <algorithm>
 #include <fstream>
+#include <functional>
+#include <stdexcept>
 
 namespace ClassProject {
 
@@ -12,6 +14,9 @@ Manager::Manager()
 
     const UniqueTableEntry true_entry = {"True", TRUE_ID, TRUE_ID, TRUE_ID, TRUE_ID};
     addTableEntry(true_entry);
+
+    add_terminal_ids = {{0.0, FALSE_ID}, {1.0, TRUE_ID}};
+    add_terminal_values = {{FALSE_ID, 0.0}, {TRUE_ID, 1.0}};
 }
 
 BDD_ID Manager::createVar(const std::string &label)
@@ -20,6 +25,13 @@ BDD_ID Manager::createVar(const std::string &label)
     const UniqueTableEntry new_entry = {label, id, TRUE_ID, FALSE_ID, id};
     addTableEntry(new_entry);
 
+    // New variables are placed below all existing ones.
+    var_to_level.resize(id + 1);
+    var_to_group.resize(id + 1);
+    var_to_level[id] = level_to_var.size();
+    var_to_group[id] = id;
+    level_to_var.push_back(id);
+
     return id;
 }
 
@@ -35,12 +47,16 @@ const BDD_ID &Manager::False()
 
 bool Manager::isConstant(BDD_ID f)
 {
-    return (f == TRUE_ID || f == FALSE_ID);
+    if (f == TRUE_ID || f == FALSE_ID)
+        return true;
+
+    // ADD terminals are their own high and low successor.
+    return (f < unique_table_vector.size()) && (unique_table_vector[f].high == f);
 }
 
 bool Manager::isVariable(BDD_ID x)
 {
-    if (x == TRUE_ID || x == FALSE_ID)
+    if (isConstant(x))
         return false;
 
     return (x < unique_table_vector.size()) && (x == topVar(x));
@@ -75,10 +91,10 @@ BDD_ID Manager::ite(BDD_ID i, BDD_ID t, BDD_ID e)
         return it->second;
 
     BDD_ID x = topVar(i);
-    if (!isConstant(t) && (topVar(t) < x))
+    if (topLevel(t) < topLevel(i))
         x = topVar(t);
 
-    if (!isConstant(e) && (topVar(e) < x))
+    if (topLevel(e) < var_to_level[x])
         x = topVar(e);
 
     const BDD_ID high = ite(coFactorTrue(i, x), coFactorTrue(t, x), coFactorTrue(e, x));
@@ -90,27 +106,39 @@ BDD_ID Manager::ite(BDD_ID i, BDD_ID t, BDD_ID e)
         return high;
     }
 
-    const BDD_ID id = unique_table_vector.size();
+    const BDD_ID id = findOrAddNode(x, high, low);
+    computed_table_map.insert({key, id});
+    return id;
+}
 
-    const UniqueTableEntry entry = {.id = id, .high = high, .low = low, .top = x};
+BDD_ID Manager::findOrAddNode(BDD_ID top, BDD_ID high, BDD_ID low)
+{
+    const BDD_ID id = free_ids.empty() ? unique_table_vector.size() : free_ids.back();
+
+    const UniqueTableEntry entry = {.id = id, .high = high, .low = low, .top = top};
 
     auto ret =
         unique_table_set.insert(entry); // will insert only if top/high/low triple does not exist
 
     if (ret.second) // was inserted
     {
-        unique_table_vector.push_back(entry);
-        computed_table_map.insert({key, id});
+        if (free_ids.empty())
+        {
+            unique_table_vector.push_back(entry);
+        }
+        else
+        {
+            unique_table_vector[id] = entry;
+            free_ids.pop_back();
+        }
         return id;
     }
 
-    computed_table_map.insert({key, ret.first->id});
     return ret.first->id; // was not inserted, already existed
 }
 
 BDD_ID Manager::coFactorTrue(BDD_ID f, BDD_ID x)
 {
-    //if (isConstant(f) || (topVar(x) < topVar(f)))
     if (isConstant(f))
         return f;
 
@@ -119,6 +147,10 @@ BDD_ID Manager::coFactorTrue(BDD_ID f, BDD_ID x)
         if (topVar(f) == x)
             return unique_table_vector[f].high;
 
+        // f does not depend on variables above its top variable.
+        if (!isVariable(x) || (var_to_level[x] < topLevel(f)))
+            return f;
+
         return ite(topVar(f), coFactorTrue(unique_table_vector[f].high, x),
                    coFactorTrue(unique_table_vector[f].low, x));
     }
@@ -128,7 +160,6 @@ BDD_ID Manager::coFactorTrue(BDD_ID f, BDD_ID x)
 
 BDD_ID Manager::coFactorFalse(BDD_ID f, BDD_ID x)
 {
-    //if (isConstant(f) || (topVar(x) < topVar(f)))
     if (isConstant(f))
         return f;
 
@@ -137,6 +168,10 @@ BDD_ID Manager::coFactorFalse(BDD_ID f, BDD_ID x)
         if (topVar(f) == x)
             return unique_table_vector[f].low;
 
+        // f does not depend on variables above its top variable.
+        if (!isVariable(x) || (var_to_level[x] < topLevel(f)))
+            return f;
+
         return ite(topVar(f), coFactorFalse(unique_table_vector[f].high, x),
                    coFactorFalse(unique_table_vector[f].low, x));
     }
@@ -201,7 +236,9 @@ std::string Manager::getTopVarName(const BDD_ID &root)
 
 void Manager::findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root)
 {
-    nodes_of_root.insert(root);
+    // Shared subgraphs are visited once.
+    if (!nodes_of_root.insert(root).second)
+        return;
 
     if (!isConstant(root))
     {
@@ -212,15 +249,14 @@ void Manager::findNodes(const BDD_ID &root, std::set<BDD_ID> &nodes_of_root)
 
 void Manager::findVars(const BDD_ID &root, std::set<BDD_ID> &vars_of_root)
 {
-    if (!isConstant(root))
-    {
-        vars_of_root.insert(topVar(root));
+    // Visits every node once instead of every path.
+    std::set<BDD_ID> nodes;
+    findNodes(root, nodes);
 
-        if (root != topVar(root))
-        {
-            findVars(coFactorTrue(root), vars_of_root);
-            findVars(coFactorFalse(root), vars_of_root);
-        }
+    for (BDD_ID node : nodes)
+    {
+        if (!isConstant(node))
+            vars_of_root.insert(topVar(node));
     }
 }
 
@@ -262,4 +298,866 @@ void Manager::visualizeBDD(std::string filepath, BDD_ID &root)
     file << "\n}\n";
 }
 
+BDD_ID Manager::pickOneCube(BDD_ID f)
+{
+    if ((f == FALSE_ID) || (f >= unique_table_vector.size()))
+        return f;
+
+    // In a reduced BDD every node other than False has a child that is not
+    // False, so greedily avoiding False always ends up in True.
+    Cube path;
+    while (!isConstant(f))
+    {
+        const UniqueTableEntry &entry = unique_table_vector[f];
+        const bool take_high = (entry.high != FALSE_ID);
+        path.push_back({entry.top, take_high});
+        f = take_high ? entry.high : entry.low;
+    }
+
+    // Build the cube bottom-up so that every ite() call terminates at once.
+    BDD_ID cube = TRUE_ID;
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+        cube = it->second ? ite(it->first, cube, FALSE_ID) : ite(it->first, FALSE_ID, cube);
+
+    return cube;
+}
+
+BDD_ID Manager::restrict(BDD_ID f, BDD_ID c)
+{
+    // Outside the care set any value will do.
+    if (c == FALSE_ID)
+        return FALSE_ID;
+
+    if ((c == TRUE_ID) || isConstant(f))
+        return f;
+
+    if (f == c)
+        return TRUE_ID;
+
+    const ComputedTableEntry key = {f, c, FALSE_ID};
+    auto it = restrict_table_map.find(key);
+    if (it != restrict_table_map.end())
+        return it->second;
+
+    const UniqueTableEntry &f_entry = unique_table_vector[f];
+    const UniqueTableEntry &c_entry = unique_table_vector[c];
+    BDD_ID result;
+
+    if (topLevel(c) < topLevel(f))
+    {
+        // f does not depend on the top variable of c, so drop it from the care set.
+        result = restrict(f, or2(c_entry.high, c_entry.low));
+    }
+    else
+    {
+        const BDD_ID x = f_entry.top;
+        const BDD_ID f_high = f_entry.high;
+        const BDD_ID f_low = f_entry.low;
+        const BDD_ID c_high = (c_entry.top == x) ? c_entry.high : c;
+        const BDD_ID c_low = (c_entry.top == x) ? c_entry.low : c;
+
+        if (c_high == FALSE_ID)
+            result = restrict(f_low, c_low);
+        else if (c_low == FALSE_ID)
+            result = restrict(f_high, c_high);
+        else
+            result = ite(x, restrict(f_high, c_high), restrict(f_low, c_low));
+    }
+
+    restrict_table_map.insert({key, result});
+    return result;
+}
+
+size_t Manager::nodeCount(BDD_ID f)
+{
+    // Nodes visited by this call carry its stamp, so the buffer is never
+    // cleared and the count stays linear in the size of f.
+    if (count_stamps.size() < unique_table_vector.size())
+        count_stamps.resize(unique_table_vector.size(), 0);
+
+    const size_t stamp = ++count_stamp;
+    size_t count = 0;
+    count_pending.clear();
+    count_pending.push_back(f);
+
+    while (!count_pending.empty())
+    {
+        const BDD_ID node = count_pending.back();
+        count_pending.pop_back();
+
+        if (count_stamps[node] == stamp)
+            continue;
+
+        count_stamps[node] = stamp;
+        count++;
+
+        if (isConstant(node))
+            continue;
+
+        count_pending.push_back(unique_table_vector[node].high);
+        count_pending.push_back(unique_table_vector[node].low);
+    }
+
+    return count;
+}
+
+std::vector<BDD_ID> Manager::support(BDD_ID f)
+{
+    std::unordered_set<BDD_ID> visited;
+    std::vector<BDD_ID> pending = {f};
+    std::vector<BDD_ID> vars;
+
+    while (!pending.empty())
+    {
+        const BDD_ID node = pending.back();
+        pending.pop_back();
+
+        if (isConstant(node) || !visited.insert(node).second)
+            continue;
+
+        vars.push_back(unique_table_vector[node].top);
+        pending.push_back(unique_table_vector[node].high);
+        pending.push_back(unique_table_vector[node].low);
+    }
+
+    std::sort(vars.begin(), vars.end(),
+              [this](BDD_ID a, BDD_ID b) { return var_to_level[a] < var_to_level[b]; });
+    vars.erase(std::unique(vars.begin(), vars.end()), vars.end());
+
+    return vars;
+}
+
+BDD_ID Manager::makeCube(const std::vector<BDD_ID> &vars)
+{
+    std::vector<BDD_ID> sorted_vars = vars;
+    std::sort(sorted_vars.begin(), sorted_vars.end(),
+              [this](BDD_ID a, BDD_ID b) { return var_to_level[a] < var_to_level[b]; });
+
+    // Build bottom-up so that every ite() call terminates at once.
+    BDD_ID cube = TRUE_ID;
+    for (auto it = sorted_vars.rbegin(); it != sorted_vars.rend(); ++it)
+        cube = ite(*it, cube, FALSE_ID);
+
+    return cube;
+}
+
+BDD_ID Manager::exists(BDD_ID f, BDD_ID cube)
+{
+    if (isConstant(f))
+        return f;
+
+    // Variables above the top variable of f do not occur in f.
+    const BDD_ID x = unique_table_vector[f].top;
+    while (topLevel(cube) < var_to_level[x])
+        cube = unique_table_vector[cube].high;
+
+    if (cube == TRUE_ID)
+        return f;
+
+    const ComputedTableEntry key = {f, cube, TRUE_ID};
+    auto it = exists_table_map.find(key);
+    if (it != exists_table_map.end())
+        return it->second;
+
+    const BDD_ID high = unique_table_vector[f].high;
+    const BDD_ID low = unique_table_vector[f].low;
+    BDD_ID result;
+
+    if (unique_table_vector[cube].top == x)
+    {
+        const BDD_ID rest = unique_table_vector[cube].high;
+        const BDD_ID high_result = exists(high, rest);
+        result = (high_result == TRUE_ID) ? TRUE_ID : or2(high_result, exists(low, rest));
+    }
+    else
+    {
+        result = ite(x, exists(high, cube), exists(low, cube));
+    }
+
+    exists_table_map.insert({key, result});
+    return result;
+}
+
+BDD_ID Manager::andExists(BDD_ID f, BDD_ID g, BDD_ID cube)
+{
+    if ((f == FALSE_ID) || (g == FALSE_ID))
+        return FALSE_ID;
+
+    if ((f == TRUE_ID) || (f == g))
+        return exists(g, cube);
+
+    if (g == TRUE_ID)
+        return exists(f, cube);
+
+    // Conjunction is commutative, normalize the operands for the cache.
+    if (g < f)
+        std::swap(f, g);
+
+    const BDD_ID x = (topLevel(f) < topLevel(g)) ? unique_table_vector[f].top : unique_table_vector[g].top;
+    while (topLevel(cube) < var_to_level[x])
+        cube = unique_table_vector[cube].high;
+
+    if (cube == TRUE_ID)
+        return and2(f, g);
+
+    // Entries of exists() carry True in the third slot, which cannot clash
+    // with the non-empty cube stored there by the relational product.
+    const ComputedTableEntry key = {f, g, cube};
+    auto it = exists_table_map.find(key);
+    if (it != exists_table_map.end())
+        return it->second;
+
+    const UniqueTableEntry &f_entry = unique_table_vector[f];
+    const UniqueTableEntry &g_entry = unique_table_vector[g];
+    const BDD_ID f_high = (f_entry.top == x) ? f_entry.high : f;
+    const BDD_ID f_low = (f_entry.top == x) ? f_entry.low : f;
+    const BDD_ID g_high = (g_entry.top == x) ? g_entry.high : g;
+    const BDD_ID g_low = (g_entry.top == x) ? g_entry.low : g;
+    BDD_ID result;
+
+    if (unique_table_vector[cube].top == x)
+    {
+        const BDD_ID rest = unique_table_vector[cube].high;
+        const BDD_ID high_result = andExists(f_high, g_high, rest);
+        result = (high_result == TRUE_ID) ? TRUE_ID
+                                          : or2(high_result, andExists(f_low, g_low, rest));
+    }
+    else
+    {
+        result = ite(x, andExists(f_high, g_high, cube), andExists(f_low, g_low, cube));
+    }
+
+    exists_table_map.insert({key, result});
+    return result;
+}
+
+BDD_ID Manager::rename(BDD_ID f, const std::unordered_map<BDD_ID, BDD_ID> &substitution)
+{
+    std::unordered_map<BDD_ID, BDD_ID> renamed;
+
+    std::function<BDD_ID(BDD_ID)> rec = [&](BDD_ID node) -> BDD_ID {
+        if (isConstant(node))
+            return node;
+
+        auto it = renamed.find(node);
+        if (it != renamed.end())
+            return it->second;
+
+        const BDD_ID top = unique_table_vector[node].top;
+        const BDD_ID high = rec(unique_table_vector[node].high);
+        const BDD_ID low = rec(unique_table_vector[node].low);
+
+        auto var = substitution.find(top);
+        const BDD_ID result = ite((var != substitution.end()) ? var->second : top, high, low);
+
+        renamed.insert({node, result});
+        return result;
+    };
+
+    return rec(f);
+}
+
+CubeRange Manager::cubes(BDD_ID f)
+{
+    return CubeRange(this, f, {}, false);
+}
+
+CubeRange Manager::minterms(BDD_ID f, const std::vector<BDD_ID> &vars)
+{
+    return CubeRange(this, f, vars, true);
+}
+
+CubeRange::CubeRange(Manager *manager, BDD_ID root, vector<BDD_ID> vars, bool minterms)
+    : manager(manager), root(root), vars(std::move(vars)), minterm_mode(minterms)
+{
+    // Minterms are expanded top-down, so the list must follow the variable order.
+    std::sort(this->vars.begin(), this->vars.end(), [manager](BDD_ID a, BDD_ID b) {
+        return manager->getLevel(a) < manager->getLevel(b);
+    });
+    this->vars.erase(std::unique(this->vars.begin(), this->vars.end()), this->vars.end());
+}
+
+CubeIterator::CubeIterator(Manager *manager, BDD_ID root, const vector<BDD_ID> *vars)
+    : manager(manager), vars(vars)
+{
+    if (root >= manager->unique_table_vector.size())
+        throw std::runtime_error("CubeIterator: root is a non-existent BDD_ID.");
+
+    if (!descend(root, 0))
+        advance();
+}
+
+CubeIterator &CubeIterator::operator++()
+{
+    advance();
+    return *this;
+}
+
+void CubeIterator::advance()
+{
+    while (true)
+    {
+        // Resume at the deepest choice whose low branch has not been visited yet.
+        while (!choices.empty() && choices.back().low_taken)
+        {
+            choices.pop_back();
+            cube.pop_back();
+        }
+
+        if (choices.empty())
+        {
+            manager = nullptr;
+            return;
+        }
+
+        choices.back().low_taken = true;
+        cube.back().second = false;
+
+        if (descend(choices.back().low, choices.back().level))
+            return;
+    }
+}
+
+bool CubeIterator::descend(BDD_ID node, size_t level)
+{
+    const BDD_ID false_id = manager->False();
+    const BDD_ID true_id = manager->True();
+
+    // Follow high branches first until the path is complete or dead.
+    while (node != false_id)
+    {
+        const bool path_complete = vars ? (level == vars->size()) : manager->isConstant(node);
+
+        if (path_complete && (node == true_id))
+            return true;
+
+        const Manager::UniqueTableEntry &entry = manager->unique_table_vector[node];
+        BDD_ID var = entry.top;
+        BDD_ID high = entry.high;
+        BDD_ID low = entry.low;
+
+        if (vars)
+        {
+            if (!path_complete)
+                var = (*vars)[level];
+
+            if (path_complete || (manager->topLevel(node) < manager->var_to_level[var]))
+                throw std::runtime_error(
+                    "minterms() function depends on a variable outside the given list.");
+
+            // Node does not depend on this variable, both values lead to it.
+            if (var != entry.top)
+                high = low = node;
+        }
+
+        choices.push_back({low, level + 1, false});
+        cube.push_back({var, true});
+        node = high;
+        level++;
+    }
+
+    return false;
+}
+
+bool Manager::evaluate(BDD_ID f, const std::vector<bool> &assignment)
+{
+    return evaluateWith(f, [&assignment](BDD_ID var)
+    {
+        if (var >= assignment.size())
+            throw std::runtime_error("evaluate() assignment does not cover all variables of f.");
+
+        return static_cast<bool>(assignment[var]);
+    });
+}
+
+bool Manager::evaluate(BDD_ID f, const std::vector<uint64_t> &assignment)
+{
+    return evaluateWith(f, [&assignment](BDD_ID var)
+    {
+        if (var / 64 >= assignment.size())
+            throw std::runtime_error("evaluate() assignment does not cover all variables of f.");
+
+        return ((assignment[var / 64] >> (var % 64)) & 1u) != 0;
+    });
+}
+
+uint64_t Manager::evaluate64(BDD_ID f, const std::vector<uint64_t> &assignments)
+{
+    // Each node evaluates to (v AND high) OR (NOT v AND low) bitwise, so the
+    // nodes are visited children first, each once. A value in the scratch
+    // buffer is valid if its stamp is the one of this call, which saves
+    // clearing the buffer.
+    if (eval64_values.size() < unique_table_vector.size())
+    {
+        eval64_values.resize(unique_table_vector.size());
+        eval64_stamps.resize(unique_table_vector.size(), 0);
+    }
+
+    const size_t stamp = ++eval64_stamp;
+    eval64_values[FALSE_ID] = 0;
+    eval64_values[TRUE_ID] = ~uint64_t(0);
+    eval64_stamps[FALSE_ID] = stamp;
+    eval64_stamps[TRUE_ID] = stamp;
+
+    eval64_pending.clear();
+    eval64_pending.push_back(f);
+
+    while (!eval64_pending.empty())
+    {
+        const BDD_ID node = eval64_pending.back();
+
+        if (eval64_stamps[node] == stamp)
+        {
+            eval64_pending.pop_back();
+            continue;
+        }
+
+        const UniqueTableEntry &entry = unique_table_vector[node];
+
+        if (eval64_stamps[entry.high] != stamp || eval64_stamps[entry.low] != stamp)
+        {
+            eval64_pending.push_back(entry.high);
+            eval64_pending.push_back(entry.low);
+            continue;
+        }
+
+        if (entry.top >= assignments.size())
+            throw std::runtime_error("evaluate64() assignments do not cover all variables of f.");
+
+        const uint64_t var = assignments[entry.top];
+        eval64_values[node] = (var & eval64_values[entry.high]) | (~var & eval64_values[entry.low]);
+        eval64_stamps[node] = stamp;
+        eval64_pending.pop_back();
+    }
+
+    return eval64_values[f];
+}
+
+BDD_ID Manager::addConst(double value)
+{
+    auto it = add_terminal_ids.find(value);
+    if (it != add_terminal_ids.end())
+        return it->second;
+
+    const BDD_ID id = unique_table_vector.size();
+    const UniqueTableEntry entry = {std::to_string(value), id, id, id, id};
+    addTableEntry(entry);
+
+    add_terminal_ids[value] = id;
+    add_terminal_values[id] = value;
+
+    return id;
+}
+
+double Manager::addValue(BDD_ID terminal)
+{
+    auto it = add_terminal_values.find(terminal);
+    if (it == add_terminal_values.end())
+        throw std::runtime_error("addValue() argument is not an ADD terminal.");
+
+    return it->second;
+}
+
+BDD_ID Manager::addApply(BDD_ID f, BDD_ID g, AddOperation op)
+{
+    if (isConstant(f) && isConstant(g))
+    {
+        const double a = addValue(f);
+        const double b = addValue(g);
+
+        switch (op)
+        {
+            case AddOperation::Plus:
+                return addConst(a + b);
+            case AddOperation::Times:
+                return addConst(a * b);
+            case AddOperation::Minimum:
+                return addConst(std::min(a, b));
+            case AddOperation::Maximum:
+                return addConst(std::max(a, b));
+        }
+    }
+
+    // All operations are commutative.
+    if (g < f)
+        std::swap(f, g);
+
+    const ComputedTableEntry key = {f, g, static_cast<BDD_ID>(op)};
+    auto it = apply_table_map.find(key);
+    if (it != apply_table_map.end())
+        return it->second;
+
+    const BDD_ID x = (topLevel(f) < topLevel(g)) ? topVar(f) : topVar(g);
+
+    const UniqueTableEntry &f_node = unique_table_vector[f];
+    const UniqueTableEntry &g_node = unique_table_vector[g];
+    const bool f_split = !isConstant(f) && (f_node.top == x);
+    const bool g_split = !isConstant(g) && (g_node.top == x);
+    const BDD_ID f_high = f_split ? f_node.high : f, f_low = f_split ? f_node.low : f;
+    const BDD_ID g_high = g_split ? g_node.high : g, g_low = g_split ? g_node.low : g;
+
+    const BDD_ID high = addApply(f_high, g_high, op);
+    const BDD_ID low = addApply(f_low, g_low, op);
+    const BDD_ID result = (high == low) ? high : findOrAddNode(x, high, low);
+
+    apply_table_map.insert({key, result});
+    return result;
+}
+
+size_t Manager::getLevel(BDD_ID x)
+{
+    if (!isVariable(x))
+        throw std::runtime_error("getLevel: BDD_ID is not a variable.");
+
+    return var_to_level[x];
+}
+
+BDD_ID Manager::getVarAtLevel(size_t level)
+{
+    if (level >= level_to_var.size())
+        throw std::runtime_error("getVarAtLevel: level does not exist.");
+
+    return level_to_var[level];
+}
+
+void Manager::groupVariables(const std::vector<BDD_ID> &vars)
+{
+    if (vars.empty())
+        return;
+
+    std::vector<size_t> levels;
+    for (BDD_ID var : vars)
+    {
+        if (!isVariable(var))
+            throw std::runtime_error("groupVariables: BDD_ID is not a variable.");
+        levels.push_back(var_to_level[var]);
+    }
+
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+
+    const size_t first = levels.front();
+    const size_t last = levels.back();
+    if (last - first + 1 != levels.size())
+        throw std::runtime_error("groupVariables: variables are not on adjacent levels.");
+
+    // Groups occupy adjacent levels, so a group is split exactly if it
+    // reaches across the boundary of the new one.
+    if ((first > 0) &&
+        (var_to_group[level_to_var[first - 1]] == var_to_group[level_to_var[first]]))
+        throw std::runtime_error("groupVariables: variables would split an existing group.");
+
+    if ((last + 1 < level_to_var.size()) &&
+        (var_to_group[level_to_var[last + 1]] == var_to_group[level_to_var[last]]))
+        throw std::runtime_error("groupVariables: variables would split an existing group.");
+
+    const BDD_ID group = *std::min_element(vars.begin(), vars.end());
+    for (BDD_ID var : vars)
+        var_to_group[var] = group;
+}
+
+void Manager::swapLevels(size_t level)
+{
+    if (level + 1 >= level_to_var.size())
+        throw std::runtime_error("swapLevels: level does not exist.");
+
+    const BDD_ID x = level_to_var[level];
+    const BDD_ID y = level_to_var[level + 1];
+    const bool x_grouped =
+        ((level > 0) && (var_to_group[level_to_var[level - 1]] == var_to_group[x])) ||
+        (var_to_group[y] == var_to_group[x]);
+    const bool y_grouped =
+        ((level + 2 < level_to_var.size()) &&
+         (var_to_group[level_to_var[level + 2]] == var_to_group[y])) ||
+        (var_to_group[y] == var_to_group[x]);
+
+    if (x_grouped || y_grouped)
+        throw std::runtime_error("swapLevels: variables belong to a group.");
+
+    vector<vector<BDD_ID>> nodes_by_var = nodesByVar();
+    exchangeLevels(level, nodes_by_var);
+}
+
+vector<vector<BDD_ID>> Manager::nodesByVar()
+{
+    vector<vector<BDD_ID>> nodes_by_var(var_to_level.size());
+
+    for (BDD_ID node = 0; node < unique_table_vector.size(); node++)
+    {
+        if (!isConstant(node) && !isFree(node))
+            nodes_by_var[unique_table_vector[node].top].push_back(node);
+    }
+
+    return nodes_by_var;
+}
+
+void Manager::exchangeLevels(size_t level, vector<vector<BDD_ID>> &nodes_by_var)
+{
+    const BDD_ID x = level_to_var[level];
+    const BDD_ID y = level_to_var[level + 1];
+
+    auto cofactors = [this, y](BDD_ID f) -> std::pair<BDD_ID, BDD_ID> {
+        if (!isConstant(f) && (unique_table_vector[f].top == y))
+            return {unique_table_vector[f].high, unique_table_vector[f].low};
+        return {f, f};
+    };
+
+    auto node = [this, x, &nodes_by_var](BDD_ID high, BDD_ID low) -> BDD_ID {
+        if (high == low)
+            return high;
+
+        // New nodes may reuse freed IDs, so only the set tells whether one was added.
+        const size_t table_size = unique_table_set.size();
+        const BDD_ID id = findOrAddNode(x, high, low);
+        if (unique_table_set.size() > table_size)
+            nodes_by_var[x].push_back(id);
+        return id;
+    };
+
+    vector<BDD_ID> x_nodes;
+    x_nodes.swap(nodes_by_var[x]);
+
+    for (BDD_ID n : x_nodes)
+    {
+        // Copy, since creating nodes may reallocate the table.
+        const UniqueTableEntry entry = unique_table_vector[n];
+        const auto high = cofactors(entry.high);
+        const auto low = cofactors(entry.low);
+
+        // Nodes that do not depend on y keep their structure.
+        if ((high.first == entry.high) && (low.first == entry.low))
+        {
+            nodes_by_var[x].push_back(n);
+            continue;
+        }
+
+        // n = y ? (x ? H1 : L1) : (x ? H0 : L0)
+        const BDD_ID new_high = node(high.first, low.first);
+        const BDD_ID new_low = node(high.second, low.second);
+
+        unique_table_set.erase(entry);
+        unique_table_vector[n].top = y;
+        unique_table_vector[n].high = new_high;
+        unique_table_vector[n].low = new_low;
+        unique_table_set.insert(unique_table_vector[n]);
+        nodes_by_var[y].push_back(n);
+    }
+
+    level_to_var[level] = y;
+    level_to_var[level + 1] = x;
+    var_to_level[y] = level;
+    var_to_level[x] = level + 1;
+}
+
+void Manager::exchangeBlocks(size_t upper, size_t upper_size, size_t lower_size,
+                             vector<vector<BDD_ID>> &nodes_by_var)
+{
+    // Bubble each variable of the lower block up through the upper block.
+    for (size_t i = 0; i < lower_size; i++)
+    {
+        for (size_t level = upper + upper_size + i; level > upper + i; level--)
+            exchangeLevels(level - 1, nodes_by_var);
+    }
+}
+
+size_t Manager::reorder(const std::vector<BDD_ID> &roots)
+{
+    vector<vector<BDD_ID>> nodes_by_var = nodesByVar();
+
+    // Nodes shared by the roots. Nodes that became unreachable stay in the
+    // table but do not count.
+    auto size = [this, &roots]() -> size_t {
+        std::unordered_set<BDD_ID> visited;
+        std::vector<BDD_ID> pending = roots;
+
+        while (!pending.empty())
+        {
+            const BDD_ID node = pending.back();
+            pending.pop_back();
+
+            if (isConstant(node) || !visited.insert(node).second)
+                continue;
+
+            pending.push_back(unique_table_vector[node].high);
+            pending.push_back(unique_table_vector[node].low);
+        }
+
+        return visited.size();
+    };
+
+    // Blocks are the maximal runs of levels with the same group, stored as
+    // (first level, number of levels).
+    auto blocks = [this]() -> std::vector<std::pair<size_t, size_t>> {
+        std::vector<std::pair<size_t, size_t>> result;
+        for (size_t level = 0; level < level_to_var.size(); level++)
+        {
+            if ((level > 0) &&
+                (var_to_group[level_to_var[level]] == var_to_group[level_to_var[level - 1]]))
+                result.back().second++;
+            else
+                result.push_back({level, 1});
+        }
+        return result;
+    };
+
+    auto position = [this, &blocks](BDD_ID group) -> size_t {
+        const auto current = blocks();
+        for (size_t i = 0; i < current.size(); i++)
+        {
+            if (var_to_group[level_to_var[current[i].first]] == group)
+                return i;
+        }
+        return current.size();
+    };
+
+    // Sift the groups with the most nodes first.
+    std::unordered_map<BDD_ID, size_t> group_nodes;
+    {
+        std::unordered_set<BDD_ID> visited;
+        std::vector<BDD_ID> pending = roots;
+        while (!pending.empty())
+        {
+            const BDD_ID node = pending.back();
+            pending.pop_back();
+
+            if (isConstant(node) || !visited.insert(node).second)
+                continue;
+
+            group_nodes[var_to_group[unique_table_vector[node].top]]++;
+            pending.push_back(unique_table_vector[node].high);
+            pending.push_back(unique_table_vector[node].low);
+        }
+    }
+
+    std::vector<BDD_ID> groups;
+    for (const auto &block : blocks())
+        groups.push_back(var_to_group[level_to_var[block.first]]);
+
+    std::stable_sort(groups.begin(), groups.end(), [&group_nodes](BDD_ID a, BDD_ID b) {
+        return group_nodes[a] > group_nodes[b];
+    });
+
+    size_t best_size = size();
+
+    for (BDD_ID group : groups)
+    {
+        if (group_nodes[group] == 0)
+            break;
+
+        size_t pos = position(group);
+        const size_t start_pos = pos;
+        size_t best_pos = pos;
+        const size_t limit = best_size + best_size / 5;
+
+        auto move_down = [&]() {
+            const auto current = blocks();
+            exchangeBlocks(current[pos].first, current[pos].second, current[pos + 1].second,
+                           nodes_by_var);
+            pos++;
+        };
+
+        auto move_up = [&]() {
+            const auto current = blocks();
+            exchangeBlocks(current[pos - 1].first, current[pos - 1].second, current[pos].second,
+                           nodes_by_var);
+            pos--;
+        };
+
+        // Down to the bottom, then up to the top, giving up on a direction
+        // once the BDDs grow too much.
+        const size_t block_count = blocks().size();
+        while (pos + 1 < block_count)
+        {
+            move_down();
+            const size_t current_size = size();
+            if (current_size < best_size)
+            {
+                best_size = current_size;
+                best_pos = pos;
+            }
+            if (current_size > limit)
+                break;
+        }
+
+        while (pos > 0)
+        {
+            move_up();
+            const size_t current_size = size();
+            if (current_size < best_size)
+            {
+                best_size = current_size;
+                best_pos = pos;
+            }
+            if ((current_size > limit) && (pos < start_pos))
+                break;
+        }
+
+        while (pos < best_pos)
+            move_down();
+        while (pos > best_pos)
+            move_up();
+    }
+
+    return size();
+}
+
+size_t Manager::collectGarbage(const std::vector<BDD_ID> &roots)
+{
+    const size_t table_size = unique_table_vector.size();
+
+    for (BDD_ID root : roots)
+    {
+        if ((root >= table_size) || isFree(root))
+            throw std::runtime_error("collectGarbage: root does not exist.");
+    }
+
+    vector<bool> live(table_size, false);
+    live[FALSE_ID] = true;
+    live[TRUE_ID] = true;
+    for (BDD_ID var : level_to_var)
+        live[var] = true;
+    for (const auto &terminal : add_terminal_values)
+        live[terminal.first] = true;
+
+    std::vector<BDD_ID> pending = roots;
+    while (!pending.empty())
+    {
+        const BDD_ID node = pending.back();
+        pending.pop_back();
+
+        if (live[node])
+            continue;
+
+        live[node] = true;
+        pending.push_back(unique_table_vector[node].high);
+        pending.push_back(unique_table_vector[node].low);
+    }
+
+    // Sweep from the top, so that the smallest free IDs are reused first.
+    size_t freed = 0;
+    for (BDD_ID node = table_size; node-- > 0;)
+    {
+        if (live[node] || isFree(node))
+            continue;
+
+        unique_table_set.erase(unique_table_vector[node]);
+        unique_table_vector[node] = {.label = "", .id = node, .high = FALSE_ID, .low = FALSE_ID, .top = FALSE_ID};
+        free_ids.push_back(node);
+        freed++;
+    }
+
+    // Cached results may refer to freed IDs.
+    computed_table_map.clear();
+    restrict_table_map.clear();
+    exists_table_map.clear();
+    apply_table_map.clear();
+
+    return freed;
+}
+
+size_t Manager::liveNodeCount()
+{
+    return unique_table_vector.size() - free_ids.size();
+}
+
 } // namespace ClassProject
@@ -8,6 +8,7 @@
 #include "ManagerInterface.h"
 
 #include <cstdint>
+#include <iterator>
 #include <unordered_set>
 #include <unordered_map>
 #include <vector>
@@ -17,6 +18,108 @@ namespace ClassProject {
 
 using namespace std;
 
+class Manager;
+
+// A conjunction of literals, given as (variable, value) pairs in variable order.
+typedef vector<pair<BDD_ID, bool>> Cube;
+
+// Terminal operations combining two ADDs with addApply().
+enum class AddOperation
+{
+    Plus,
+    Times,
+    Minimum,
+    Maximum
+};
+
+// Input iterator lazily walking the paths of a BDD that lead to True. Each
+// dereference yields the cube of the current path. If a variable list is
+// given, variables skipped along a path are expanded so that every yielded
+// cube is a minterm over exactly these variables.
+class CubeIterator
+{
+public:
+    using iterator_category = input_iterator_tag;
+    using value_type = Cube;
+    using difference_type = ptrdiff_t;
+    using pointer = const Cube *;
+    using reference = const Cube &;
+
+    CubeIterator() = default; // past-the-end
+
+    CubeIterator(Manager *manager, BDD_ID root, const vector<BDD_ID> *vars);
+
+    reference operator*() const
+    {
+        return cube;
+    }
+
+    pointer operator->() const
+    {
+        return &cube;
+    }
+
+    CubeIterator &operator++();
+
+    CubeIterator operator++(int)
+    {
+        CubeIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const CubeIterator &other) const
+    {
+        return (manager == nullptr) ? (other.manager == nullptr) : (this == &other);
+    }
+
+    bool operator!=(const CubeIterator &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    struct Choice
+    {
+        BDD_ID low; // node to continue with once the high branch is exhausted
+        size_t level; // position in the variable list below this choice
+        bool low_taken;
+    };
+
+    Manager *manager = nullptr;
+    const vector<BDD_ID> *vars = nullptr;
+    vector<Choice> choices;
+    Cube cube;
+
+    void advance();
+
+    bool descend(BDD_ID node, size_t level);
+};
+
+// Range over the cubes of a BDD, usable in range-based for loops. The range
+// owns the variable list its iterators refer to.
+class CubeRange
+{
+public:
+    CubeRange(Manager *manager, BDD_ID root, vector<BDD_ID> vars, bool minterms);
+
+    CubeIterator begin() const
+    {
+        return CubeIterator(manager, root, minterm_mode ? &vars : nullptr);
+    }
+
+    CubeIterator end() const
+    {
+        return CubeIterator();
+    }
+
+private:
+    Manager *manager;
+    BDD_ID root;
+    vector<BDD_ID> vars;
+    bool minterm_mode;
+};
+
 class Manager : public ManagerInterface
 {
 public:
@@ -68,7 +171,120 @@ public:
 
     void visualizeBDD(std::string filepath, BDD_ID &root) override;
 
+    // Returns a single satisfying cube of f as a BDD, or False if f is
+    // unsatisfiable.
+    BDD_ID pickOneCube(BDD_ID f);
+
+    // Lazily enumerates the disjoint cubes given by the paths of f to True.
+    CubeRange cubes(BDD_ID f);
+
+    // Lazily enumerates the minterms of f over vars. The support of f must be
+    // contained in vars.
+    CubeRange minterms(BDD_ID f, const std::vector<BDD_ID> &vars);
+
+    // Generalized cofactor of f with respect to the care set c (Coudert and
+    // Madre). The result agrees with f wherever c holds and is usually smaller.
+    BDD_ID restrict(BDD_ID f, BDD_ID c);
+
+    // Number of nodes of f, including the reachable terminal nodes.
+    size_t nodeCount(BDD_ID f);
+
+    // Variables f depends on, in variable order.
+    std::vector<BDD_ID> support(BDD_ID f);
+
+    // Conjunction of the given variables, used to pass variable sets to the
+    // quantification operations.
+    BDD_ID makeCube(const std::vector<BDD_ID> &vars);
+
+    // Existential quantification of all variables in cube from f.
+    BDD_ID exists(BDD_ID f, BDD_ID cube);
+
+    // Relational product, exists(and2(f, g), cube) without building the
+    // full conjunction.
+    BDD_ID andExists(BDD_ID f, BDD_ID g, BDD_ID cube);
+
+    // Replaces each variable of f found as a key in substitution by the
+    // variable it maps to.
+    BDD_ID rename(BDD_ID f, const std::unordered_map<BDD_ID, BDD_ID> &substitution);
+
+    // Value of f under the assignment indexed by variable ID. Follows a single
+    // path from the root and creates no nodes.
+    bool evaluate(BDD_ID f, const std::vector<bool> &assignment);
+
+    // Same, with the value of variable v in bit v % 64 of assignment[v / 64].
+    bool evaluate(BDD_ID f, const std::vector<uint64_t> &assignment);
+
+    // Evaluates f under 64 assignments at once. Bit j of assignments[v] holds
+    // the value of variable v in assignment j, bit j of the result the value
+    // of f under it. Reuses its scratch buffers, so repeated calls do not
+    // allocate.
+    uint64_t evaluate64(BDD_ID f, const std::vector<uint64_t> &assignments);
+
+    // Path walk with the value of each variable v on the path given by
+    // value(v), for callers keeping their assignment in another layout.
+    template <typename Assignment>
+    bool evaluateWith(BDD_ID f, Assignment value)
+    {
+        return followPath(f, value) == TRUE_ID;
+    }
+
+    // Same walk, returning the terminal reached. Used to evaluate ADDs.
+    template <typename Assignment>
+    BDD_ID followPath(BDD_ID f, Assignment value)
+    {
+        while (!isConstant(f))
+        {
+            const UniqueTableEntry &node = unique_table_vector[f];
+            f = value(node.top) ? node.high : node.low;
+        }
+
+        return f;
+    }
+
+    // Algebraic decision diagrams (ADDs) share the unique table with the
+    // BDDs. Their terminals are constant nodes carrying a value, where False
+    // and True are the terminals of the values 0 and 1, so every BDD is also
+    // a 0/1 ADD. ite() builds ADDs from a BDD condition and ADD branches, the
+    // Boolean operations are not defined on other ADDs.
+    BDD_ID addConst(double value);
+
+    // Value of an ADD terminal.
+    double addValue(BDD_ID terminal);
+
+    // Combines the terminal values of f and g pointwise.
+    BDD_ID addApply(BDD_ID f, BDD_ID g, AddOperation op);
+
+    // The variable order starts as the creation order and can be changed
+    // later. Level 0 is the topmost level.
+    size_t getLevel(BDD_ID x);
+
+    BDD_ID getVarAtLevel(size_t level);
+
+    // Keeps the given variables, which must be on adjacent levels, together
+    // in their current relative order whenever the variables are reordered.
+    void groupVariables(const std::vector<BDD_ID> &vars);
+
+    // Exchanges the variables at level and level + 1. The nodes are rewritten
+    // in place, so every BDD_ID keeps representing the same function.
+    void swapLevels(size_t level);
+
+    // Group sifting: moves each variable group through all positions of the
+    // order and keeps it where the BDDs of roots have the fewest nodes.
+    // Returns the number of nodes of roots afterwards.
+    size_t reorder(const std::vector<BDD_ID> &roots);
+
+    // Frees every node that is not reachable from roots. Constants, variables
+    // and ADD terminals are never freed. The IDs of freed nodes become
+    // invalid and are reused by new nodes, and the computed tables are
+    // cleared. Returns the number of freed nodes.
+    size_t collectGarbage(const std::vector<BDD_ID> &roots);
+
+    // Number of nodes in the unique table that are not freed.
+    size_t liveNodeCount();
+
 private:
+    friend class CubeIterator;
+
     struct UniqueTableEntry
     {
         string label;
@@ -137,6 +353,51 @@ protected:
     vector<UniqueTableEntry> unique_table_vector; // for lookup by ID
     unordered_set<UniqueTableEntry, UniqueTableEntryHash> unique_table_set; // for lookup by triple
     unordered_map<ComputedTableEntry, BDD_ID, ComputedTableEntryHash> computed_table_map; // for caching ite results
+    unordered_map<ComputedTableEntry, BDD_ID, ComputedTableEntryHash> restrict_table_map; // for caching restrict results
+    unordered_map<ComputedTableEntry, BDD_ID, ComputedTableEntryHash> exists_table_map; // for caching quantification results
+    unordered_map<ComputedTableEntry, BDD_ID, ComputedTableEntryHash> apply_table_map; // for caching addApply results
+    unordered_map<double, BDD_ID> add_terminal_ids; // for lookup of ADD terminals by value
+    unordered_map<BDD_ID, double> add_terminal_values; // for lookup of ADD terminal values by ID
+
+    vector<size_t> var_to_level; // indexed by variable ID
+    vector<BDD_ID> level_to_var;
+    vector<BDD_ID> var_to_group; // indexed by variable ID, holds a member of the group
+    vector<BDD_ID> free_ids; // freed nodes, the next ID to reuse is at the back
+
+    vector<uint64_t> eval64_values; // evaluate64 scratch, indexed by node ID
+    vector<size_t> eval64_stamps; // call of evaluate64 that set eval64_values
+    size_t eval64_stamp = 0;
+    vector<BDD_ID> eval64_pending;
+
+    vector<size_t> count_stamps; // call of nodeCount that visited the node, indexed by node ID
+    size_t count_stamp = 0;
+    vector<BDD_ID> count_pending;
+
+    // Returns the node (top, high, low), creating it if it does not exist.
+    BDD_ID findOrAddNode(BDD_ID top, BDD_ID high, BDD_ID low);
+
+    // Level of the top variable of f. Constants lie below all variables.
+    size_t topLevel(BDD_ID f)
+    {
+        return isConstant(f) ? level_to_var.size() : var_to_level[unique_table_vector[f].top];
+    }
+
+    // Swaps two levels without regard to groups. nodes_by_var lists the nodes
+    // of each top variable and is kept up to date.
+    void exchangeLevels(size_t level, vector<vector<BDD_ID>> &nodes_by_var);
+
+    // Moves the block of lower_size variables starting at level upper +
+    // upper_size above the block of upper_size variables starting at upper.
+    void exchangeBlocks(size_t upper, size_t upper_size, size_t lower_size,
+                        vector<vector<BDD_ID>> &nodes_by_var);
+
+    vector<vector<BDD_ID>> nodesByVar();
+
+    // Freed nodes have the top variable False, which no other node has.
+    bool isFree(BDD_ID f)
+    {
+        return (f != FALSE_ID) && (unique_table_vector[f].top == FALSE_ID);
+    }
 
     void addTableEntry(const UniqueTableEntry &new_entry)
     {
@@ -0,0 +1,350 @@
+//
+// Reader for the ASCII (aag) and binary (aig) AIGER formats
+//
+
+#include "AigerReader.hpp"
+
+#include <limits>
+
+namespace bench_format {
+
+    namespace {
+        constexpr label_id_t NO_LABEL = std::numeric_limits<label_id_t>::max();
+    }
+
+    AigerReader::AigerReader(std::string_view data, LabelPool &labels) : data(data), labels(labels) {
+    }
+
+    bool AigerReader::ReadStatements(std::vector<bench_node_type> &statements) {
+        statements.clear();
+
+        if (!ReadHeader()) {
+            return false;
+        }
+
+        /* Inputs, latches, outputs and bad state properties, one per line */
+        std::vector<uint64_t> numbers;
+        for (uint64_t i = 0; i < inputs.size(); i++) {
+            if (binary) {
+                inputs[i] = 2 * (i + 1);
+            } else if (!ReadLine(numbers) || (numbers.size() != 1)) {
+                return Fail("invalid input " + std::to_string(i));
+            } else {
+                inputs[i] = numbers[0];
+            }
+        }
+        for (uint64_t i = 0; i < latches.size(); i++) {
+            if (!ReadLine(numbers) || (numbers.size() < (binary ? 1 : 2)) || (numbers.size() > (binary ? 2 : 3))) {
+                return Fail("invalid latch " + std::to_string(i));
+            }
+            const size_t first = binary ? 0 : 1;
+            latches[i].literal = binary ? 2 * (inputs.size() + i + 1) : numbers[0];
+            latches[i].next = numbers[first];
+            latches[i].init = (numbers.size() > first + 1) ? numbers[first + 1] : 0;
+            if (latches[i].init != 0) {
+                return Fail("latch " + std::to_string(i) + " is not reset to 0");
+            }
+        }
+        for (auto *properties : {&outputs, &bad_states}) {
+            for (auto &property : *properties) {
+                if (!ReadLine(numbers) || (numbers.size() != 1)) {
+                    return Fail("invalid output or bad state property");
+                }
+                property = numbers[0];
+            }
+        }
+        if (!ReadAnds() || !ReadSymbols()) {
+            return false;
+        }
+
+        /* Name every variable. Inputs and latches keep their symbols. */
+        variable_labels.assign(max_variable + 1, NO_LABEL);
+        inverted_labels.assign(max_variable + 1, NO_LABEL);
+        for (size_t i = 0; i < inputs.size(); i++) {
+            if (!DefineVariable(inputs[i], input_names[i], "i" + std::to_string(i))) {
+                return false;
+            }
+            statements.push_back({variable_labels[inputs[i] / 2], gate_type_t::Input, {}});
+        }
+        for (size_t i = 0; i < latches.size(); i++) {
+            if (!DefineVariable(latches[i].literal, latch_names[i], "l" + std::to_string(i))) {
+                return false;
+            }
+        }
+        for (const auto &gate : ands) {
+            if (!DefineVariable(gate.literal, "", "a" + std::to_string(gate.literal / 2))) {
+                return false;
+            }
+        }
+
+        /* The gates refer to each other by label, so their order does not matter */
+        label_id_t rhs0, rhs1;
+        for (const auto &latch : latches) {
+            if (!LiteralLabel(latch.next, statements, rhs0)) {
+                return false;
+            }
+            statements.push_back({variable_labels[latch.literal / 2], gate_type_t::FlipFlop, {rhs0}});
+        }
+        for (const auto &gate : ands) {
+            if (!LiteralLabel(gate.rhs0, statements, rhs0) || !LiteralLabel(gate.rhs1, statements, rhs1)) {
+                return false;
+            }
+            statements.push_back({variable_labels[gate.literal / 2], gate_type_t::And, {rhs0, rhs1}});
+        }
+
+        /* Outputs get their own BUFF, so they can be named and share a literal */
+        const std::pair<const std::vector<uint64_t> *, const std::vector<std::string> *> properties[] = {
+                {&outputs,    &output_names},
+                {&bad_states, &bad_state_names}};
+        for (const auto &property : properties) {
+            const char *prefix = (property.first == &outputs) ? "o" : "b";
+            for (size_t i = 0; i < property.first->size(); i++) {
+                label_id_t output, driver;
+                if (!Define((*property.second)[i], prefix + std::to_string(i), output) ||
+                    !LiteralLabel((*property.first)[i], statements, driver)) {
+                    return false;
+                }
+                statements.push_back({output, gate_type_t::Buffer, {driver}});
+                statements.push_back({output, gate_type_t::Output, {}});
+            }
+        }
+        return true;
+    }
+
+    const std::string &AigerReader::GetError() const {
+        return error;
+    }
+
+    bool AigerReader::Fail(const std::string &message) {
+        error = message;
+        return false;
+    }
+
+    bool AigerReader::ReadHeader() {
+        if ((data.substr(0, 4) == "aag ") || (data.substr(0, 4) == "aig ")) {
+            binary = (data[1] == 'i');
+            pos = 4;
+        } else {
+            return Fail("missing 'aag' or 'aig' header");
+        }
+
+        /* M I L O A, optionally followed by B C J F */
+        std::vector<uint64_t> header;
+        if (!ReadLine(header) || (header.size() < 5) || (header.size() > 9)) {
+            return Fail("invalid header");
+        }
+        header.resize(9, 0);
+        if (header[0] > (std::numeric_limits<uint64_t>::max() >> 2) ||
+            (header[1] > header[0]) || (header[2] > header[0]) || (header[4] > header[0])) {
+            return Fail("invalid header");
+        }
+        if ((header[6] != 0) || (header[7] != 0) || (header[8] != 0)) {
+            return Fail("invariant constraints, justice and fairness properties are not supported");
+        }
+        if (header[1] + header[2] + header[4] > header[0]) {
+            return Fail("more inputs, latches and AND gates than variables");
+        }
+        if (binary && (header[1] + header[2] + header[4] != header[0])) {
+            return Fail("the variables of a binary file must be inputs, latches and AND gates");
+        }
+
+        max_variable = header[0];
+        inputs.resize(header[1]);
+        latches.resize(header[2]);
+        outputs.resize(header[3]);
+        ands.resize(header[4]);
+        bad_states.resize(header[5]);
+        return true;
+    }
+
+    bool AigerReader::ReadNumber(uint64_t &number) {
+        const size_t begin = pos;
+        number = 0;
+        while ((pos < data.size()) && (data[pos] >= '0') && (data[pos] <= '9')) {
+            if (number > (std::numeric_limits<uint64_t>::max() - 9) / 10) {
+                return false;
+            }
+            number = 10 * number + (data[pos] - '0');
+            pos++;
+        }
+        return pos > begin;
+    }
+
+    bool AigerReader::ReadLine(std::vector<uint64_t> &numbers) {
+        /* Numbers separated by single spaces, up to the end of the line */
+        numbers.clear();
+        while (true) {
+            uint64_t number;
+            if (!ReadNumber(number)) {
+                return false;
+            }
+            numbers.push_back(number);
+            if ((pos == data.size()) || (data[pos] != ' ')) {
+                break;
+            }
+            pos++;
+        }
+        if ((pos == data.size()) || (data[pos] != '\n')) {
+            return false;
+        }
+        pos++;
+        return true;
+    }
+
+    bool AigerReader::ReadBinaryNumber(uint64_t &number) {
+        number = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (pos == data.size()) {
+                return false;
+            }
+            const auto byte = static_cast<unsigned char>(data[pos++]);
+            number |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool AigerReader::ReadAnds() {
+        std::vector<uint64_t> numbers;
+        for (uint64_t i = 0; i < ands.size(); i++) {
+            and_t &gate = ands[i];
+            if (binary) {
+                /* lhs > rhs0 >= rhs1, stored as the differences lhs - rhs0 and rhs0 - rhs1 */
+                uint64_t delta0, delta1;
+                gate.literal = 2 * (inputs.size() + latches.size() + i + 1);
+                if (!ReadBinaryNumber(delta0) || !ReadBinaryNumber(delta1) || (delta0 == 0) ||
+                    (delta0 > gate.literal) || (delta1 > gate.literal - delta0)) {
+                    return Fail("invalid AND gate " + std::to_string(i));
+                }
+                gate.rhs0 = gate.literal - delta0;
+                gate.rhs1 = gate.rhs0 - delta1;
+            } else {
+                if (!ReadLine(numbers) || (numbers.size() != 3)) {
+                    return Fail("invalid AND gate " + std::to_string(i));
+                }
+                gate = {numbers[0], numbers[1], numbers[2]};
+            }
+        }
+        return true;
+    }
+
+    bool AigerReader::ReadSymbols() {
+        input_names.assign(inputs.size(), "");
+        latch_names.assign(latches.size(), "");
+        output_names.assign(outputs.size(), "");
+        bad_state_names.assign(bad_states.size(), "");
+
+        /* Lines like "i0 name" until the end of the file or the comment section, which starts with "c" */
+        while (pos < data.size()) {
+            const size_t end = std::min(data.find('\n', pos), data.size());
+            const std::string_view line = data.substr(pos, end - pos);
+            pos = std::min(end + 1, data.size());
+
+            if ((line == "c") || line.empty()) {
+                break;
+            }
+
+            const size_t space = line.find(' ');
+            std::vector<std::string> *names = nullptr;
+            switch (line[0]) {
+                case 'i':
+                    names = &input_names;
+                    break;
+                case 'l':
+                    names = &latch_names;
+                    break;
+                case 'o':
+                    names = &output_names;
+                    break;
+                case 'b':
+                    names = &bad_state_names;
+                    break;
+                default:
+                    return Fail("invalid symbol '" + std::string(line) + "'");
+            }
+
+            /* The position must be a number below the count of its kind */
+            const std::string_view position = line.substr(1, (space == std::string_view::npos) ? 0 : space - 1);
+            uint64_t index = 0;
+            bool valid = !position.empty() && (position.size() < 19) && (space + 1 < line.size());
+            for (char c : position) {
+                valid = valid && (c >= '0') && (c <= '9');
+                index = 10 * index + (c - '0');
+            }
+            if (!valid || (index >= names->size())) {
+                return Fail("invalid symbol '" + std::string(line) + "'");
+            }
+            (*names)[index] = std::string(line.substr(space + 1));
+        }
+        return true;
+    }
+
+    bool AigerReader::DefineVariable(uint64_t literal, const std::string &symbol, const std::string &fallback) {
+        if ((literal & 1) || (literal < 2) || (literal / 2 > max_variable)) {
+            return Fail("invalid literal " + std::to_string(literal) + " for '" + fallback + "'");
+        }
+        if (variable_labels[literal / 2] != NO_LABEL) {
+            return Fail("variable " + std::to_string(literal / 2) + " is defined twice");
+        }
+        return Define(symbol, fallback, variable_labels[literal / 2]);
+    }
+
+    bool AigerReader::Define(const std::string &symbol, const std::string &fallback, label_id_t &label) {
+        /* Symbols are only unique per kind, so a symbol that is taken falls back to the position */
+        label_id_t existing;
+        if (!symbol.empty() && !(labels.Find(symbol, existing) && IsDefined(existing))) {
+            return Define(symbol, label);
+        }
+        return Define(fallback, label);
+    }
+
+    bool AigerReader::IsDefined(label_id_t label) const {
+        return (label < defined_labels.size()) && defined_labels[label];
+    }
+
+    bool AigerReader::Define(const std::string &name, label_id_t &label) {
+        label = labels.Intern(name);
+        if (label >= defined_labels.size()) {
+            defined_labels.resize(label + 1, false);
+        }
+        if (defined_labels[label]) {
+            return Fail("the name '" + name + "' is used twice");
+        }
+        defined_labels[label] = true;
+        return true;
+    }
+
+    bool AigerReader::LiteralLabel(uint64_t literal, std::vector<bench_node_type> &statements, label_id_t &label) {
+        const uint64_t variable = literal / 2;
+        if (variable > max_variable) {
+            return Fail("invalid literal " + std::to_string(literal));
+        }
+
+        /* Variable 0 is the constant FALSE, it is created on first use */
+        if ((variable == 0) && (variable_labels[0] == NO_LABEL)) {
+            if (!Define("const0", variable_labels[0])) {
+                return false;
+            }
+            statements.push_back({variable_labels[0], gate_type_t::Zero, {}});
+        }
+        if (variable_labels[variable] == NO_LABEL) {
+            return Fail("literal " + std::to_string(literal) + " is used but not defined");
+        }
+        if ((literal & 1) == 0) {
+            label = variable_labels[variable];
+            return true;
+        }
+
+        if (inverted_labels[variable] == NO_LABEL) {
+            const std::string name = (variable == 0) ? "const1" : labels.GetLabel(variable_labels[variable]) + "_n";
+            if (!Define(name, inverted_labels[variable])) {
+                return false;
+            }
+            statements.push_back({inverted_labels[variable], gate_type_t::Not, {variable_labels[variable]}});
+        }
+        label = inverted_labels[variable];
+        return true;
+    }
+}
@@ -0,0 +1,120 @@
+//
+// Reader for the ASCII (aag) and binary (aig) AIGER formats
+//
+
+#pragma once
+
+#include "BenchLexer.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench_format {
+
+    /**
+     * \class AigerReader
+     *
+     * \brief Translates an And-Inverter Graph into the statements of a bench file.
+     *
+     *  Both the ASCII ("aag") and the binary ("aig") variant of the AIGER
+     *  format are read, including the symbol table. The graph becomes
+     *      INPUT(x)                 for every input
+     *      x = DFF(next)            for every latch, which must be reset to 0
+     *      a<v> = AND(x, y)         for every AND gate with variable index v
+     *      x_n = NOT(x)             for every inverted literal in use
+     *      o = BUFF(lit), OUTPUT(o) for every output and bad state property
+     *  Inputs, latches and outputs are named by the symbol table, or by
+     *  their kind and position (i0, l0, o0, b0) if they have no symbol
+     *  or their symbol is already taken.
+     *  The constant literals become CONST0 and const1 = NOT(const0).
+     *  Invariant constraints, justice and fairness properties are not supported.
+     *
+     */
+    class AigerReader {
+    public:
+        /**
+         * \brief Constructor
+         * \param data is the content of the AIGER file, which must outlive the reader
+         * \param labels is the pool receiving the labels of all statements
+         *
+         */
+        AigerReader(std::string_view data, LabelPool &labels);
+
+        /**
+         * \brief reads the whole file.
+         * \param statements receives one statement per node, as if read from a bench file
+         * \return false in case of a syntax error, see GetError()
+         *
+         */
+        bool ReadStatements(std::vector<bench_node_type> &statements);
+
+        /**
+         * \brief return the description of the last error.
+         * \param none
+         * \return const std::string&
+         *
+         */
+        const std::string &GetError() const;
+
+    private:
+        struct latch_t {
+            uint64_t literal;
+            uint64_t next;
+            uint64_t init;
+        };
+
+        struct and_t {
+            uint64_t literal;
+            uint64_t rhs0;
+            uint64_t rhs1;
+        };
+
+        std::string_view data;
+        size_t pos = 0;
+        LabelPool &labels;
+        std::string error;
+
+        bool binary = false;
+        uint64_t max_variable = 0;
+        std::vector<uint64_t> inputs;
+        std::vector<latch_t> latches;
+        std::vector<uint64_t> outputs;
+        std::vector<uint64_t> bad_states;
+        std::vector<and_t> ands;
+
+        std::vector<std::string> input_names;
+        std::vector<std::string> latch_names;
+        std::vector<std::string> output_names;
+        std::vector<std::string> bad_state_names;
+
+        std::vector<label_id_t> variable_labels;  ///< Label of the positive literal of each variable
+        std::vector<label_id_t> inverted_labels;  ///< Label of the NOT gate of each variable, once emitted
+        std::vector<bool> defined_labels;         ///< Labels that already head a statement
+
+        bool Fail(const std::string &message);
+
+        bool ReadHeader();
+
+        bool ReadNumber(uint64_t &number);
+
+        bool ReadLine(std::vector<uint64_t> &numbers);
+
+        bool ReadBinaryNumber(uint64_t &number);
+
+        bool ReadAnds();
+
+        bool ReadSymbols();
+
+        bool DefineVariable(uint64_t literal, const std::string &symbol, const std::string &fallback);
+
+        bool Define(const std::string &symbol, const std::string &fallback, label_id_t &label);
+
+        bool Define(const std::string &name, label_id_t &label);
+
+        bool IsDefined(label_id_t label) const;
+
+        bool LiteralLabel(uint64_t literal, std::vector<bench_node_type> &statements, label_id_t &label);
+    };
+}
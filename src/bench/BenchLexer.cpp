@@ -0,0 +1,289 @@
+//
+// Hand-written tokenizer for the ISCAS85/89/99 bench format
+//
+
+#include "BenchLexer.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+namespace bench_format {
+
+    namespace {
+        struct gate_keyword_t {
+            std::string_view keyword;
+            gate_type_t gate_type;
+            bool single_input;
+        };
+
+        /* Gates that may appear on the right-hand side of an assignment */
+        constexpr gate_keyword_t gate_keywords[] = {
+                {NOT_GATE_T,       gate_type_t::Not,      true},
+                {BUFFER_GATE_T,    gate_type_t::Buffer,   true},
+                {FLIP_FLOP_GATE_T, gate_type_t::FlipFlop, true},
+                {AND_GATE_T,       gate_type_t::And,      false},
+                {OR_GATE_T,        gate_type_t::Or,       false},
+                {NAND_GATE_T,      gate_type_t::Nand,     false},
+                {NOR_GATE_T,       gate_type_t::Nor,      false},
+                {XOR_GATE_T,       gate_type_t::Xor,      false}};
+
+        bool IsBlank(char c) {
+            return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\v') || (c == '\f');
+        }
+
+        bool IsIdentifierChar(char c) {
+            return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) ||
+                   (c == '_') || (c == '.');
+        }
+    }
+
+    const char *GateTypeName(gate_type_t gate_type) {
+        switch (gate_type) {
+            case gate_type_t::Input:
+                return INPUT_GATE_T;
+            case gate_type_t::Output:
+                return OUTPUT_GATE_T;
+            case gate_type_t::FlipFlop:
+                return FLIP_FLOP_GATE_T;
+            case gate_type_t::Buffer:
+                return BUFFER_GATE_T;
+            case gate_type_t::Not:
+                return NOT_GATE_T;
+            case gate_type_t::And:
+                return AND_GATE_T;
+            case gate_type_t::Or:
+                return OR_GATE_T;
+            case gate_type_t::Nand:
+                return NAND_GATE_T;
+            case gate_type_t::Nor:
+                return NOR_GATE_T;
+            case gate_type_t::Xor:
+                return XOR_GATE_T;
+            case gate_type_t::Zero:
+                return ZERO_GATE_T;
+        }
+        return "";
+    }
+
+    /* ---------
+     * LabelPool
+     * ---------
+     */
+    label_id_t LabelPool::Intern(std::string_view label) {
+        auto got = ids.find(label);
+        if (got != ids.end()) {
+            return got->second;
+        }
+
+        const label_id_t id = labels.size();
+        labels.emplace_back(label);
+        ids.emplace(labels.back(), id);
+        return id;
+    }
+
+    bool LabelPool::Find(std::string_view label, label_id_t &id) const {
+        auto got = ids.find(label);
+        if (got == ids.end()) {
+            return false;
+        }
+        id = got->second;
+        return true;
+    }
+
+    const std::string &LabelPool::GetLabel(label_id_t id) const {
+        return labels.at(id);
+    }
+
+    size_t LabelPool::Size() const {
+        return labels.size();
+    }
+
+    void LabelPool::Clear() {
+        ids.clear();
+        labels.clear();
+    }
+
+    /* ----------
+     * MappedFile
+     * ----------
+     */
+    MappedFile::MappedFile(const std::string &path) {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open file: " + path);
+        }
+
+        struct stat file_status{};
+        if (fstat(fd, &file_status) != 0) {
+            close(fd);
+            throw std::runtime_error("Could not open file: " + path);
+        }
+
+        size = static_cast<size_t>(file_status.st_size);
+
+        /* Empty files cannot be mapped, but hold no statements anyway */
+        if (size > 0) {
+            void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Could not map file: " + path);
+            }
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            data = static_cast<const char *>(mapping);
+        }
+
+        /* The mapping stays valid after closing the descriptor */
+        close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data != nullptr) {
+            munmap(const_cast<char *>(data), size);
+        }
+    }
+
+    std::string_view MappedFile::GetText() const {
+        return {data, size};
+    }
+
+    /* ----------
+     * BenchLexer
+     * ----------
+     */
+    BenchLexer::BenchLexer(std::string_view text, LabelPool &labels) : text(text), labels(labels) {
+    }
+
+    bool BenchLexer::NextStatement() {
+        while (pos < text.size()) {
+            SkipBlanks();
+            if (pos == text.size()) {
+                break;
+            }
+
+            if (text[pos] == '#') {
+                while ((pos < text.size()) && (text[pos] != '\n')) {
+                    pos++;
+                }
+            } else if (text[pos] == '\n') {
+                pos++;
+                line++;
+                line_start = pos;
+            } else {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool BenchLexer::ParseStatement(bench_node_type &node) {
+        std::string_view first;
+        node.input_node_list.clear();
+
+        if (!ReadIdentifier(first)) {
+            return false;
+        }
+
+        if (Accept('(')) {
+            /* Primary INPUT or OUTPUT */
+            if (first == INPUT_GATE_T) {
+                node.gate_type = gate_type_t::Input;
+            } else if (first == OUTPUT_GATE_T) {
+                node.gate_type = gate_type_t::Output;
+            } else {
+                return false;
+            }
+
+            std::string_view label;
+            if (!ReadIdentifier(label) || !Accept(')')) {
+                return false;
+            }
+            node.label = labels.Intern(label);
+        } else {
+            /* Gate assignment */
+            std::string_view gate_type;
+            if (!Accept('=') || !ReadIdentifier(gate_type)) {
+                return false;
+            }
+
+            const gate_keyword_t *keyword = nullptr;
+            for (const auto &candidate : gate_keywords) {
+                if (gate_type == candidate.keyword) {
+                    keyword = &candidate;
+                }
+            }
+            if (keyword == nullptr) {
+                return false;
+            }
+            node.gate_type = keyword->gate_type;
+            const bool single_input = keyword->single_input;
+
+            node.label = labels.Intern(first);
+            if (!ReadInputList(node)) {
+                return false;
+            }
+
+            const size_t inputs = node.input_node_list.size();
+            if (single_input ? (inputs != 1) : (inputs < 2)) {
+                return false;
+            }
+        }
+
+        /* Only a comment may follow on the same line */
+        SkipBlanks();
+        return (pos == text.size()) || (text[pos] == '\n') || (text[pos] == '#');
+    }
+
+    size_t BenchLexer::GetLine() const {
+        return line;
+    }
+
+    std::string_view BenchLexer::GetCurrentLine() const {
+        const size_t end = text.find('\n', line_start);
+        return text.substr(line_start, (end == std::string_view::npos) ? std::string_view::npos : end - line_start);
+    }
+
+    void BenchLexer::SkipBlanks() {
+        while ((pos < text.size()) && IsBlank(text[pos])) {
+            pos++;
+        }
+    }
+
+    bool BenchLexer::Accept(char c) {
+        SkipBlanks();
+        if ((pos < text.size()) && (text[pos] == c)) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool BenchLexer::ReadIdentifier(std::string_view &identifier) {
+        SkipBlanks();
+        const size_t begin = pos;
+        while ((pos < text.size()) && IsIdentifierChar(text[pos])) {
+            pos++;
+        }
+        identifier = text.substr(begin, pos - begin);
+        return !identifier.empty();
+    }
+
+    bool BenchLexer::ReadInputList(bench_node_type &node) {
+        if (!Accept('(')) {
+            return false;
+        }
+
+        do {
+            std::string_view input;
+            if (!ReadIdentifier(input)) {
+                return false;
+            }
+            node.input_node_list.push_back(labels.Intern(input));
+        } while (Accept(','));
+
+        return Accept(')');
+    }
+}
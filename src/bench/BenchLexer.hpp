@@ -0,0 +1,208 @@
+//
+// Hand-written tokenizer for the ISCAS85/89/99 bench format
+//
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+#define OUTPUT_GATE_T    "OUTPUT"
+#define INPUT_GATE_T     "INPUT"
+#define FLIP_FLOP_GATE_T "DFF"
+#define BUFFER_GATE_T    "BUFF"
+#define NOT_GATE_T       "NOT"
+#define AND_GATE_T       "AND"
+#define OR_GATE_T        "OR"
+#define NAND_GATE_T      "NAND"
+#define NOR_GATE_T       "NOR"
+#define XOR_GATE_T       "XOR"
+#define ZERO_GATE_T      "CONST0"
+
+namespace bench_format {
+
+    typedef size_t label_id_t; ///< Type definition for the index of a label in a LabelPool
+
+    /**
+     * \enum gate_type_t
+     * \brief Types of the nodes of a bench file, named by the *_GATE_T keywords.
+     *
+     *  Zero is the constant FALSE. It has no bench syntax and only comes from AIGER files.
+     */
+    enum class gate_type_t : unsigned char {
+        Input, Output, FlipFlop, Buffer, Not, And, Or, Nand, Nor, Xor, Zero
+    };
+
+    /**
+     * \brief return the keyword of a gate type.
+     * \param gate_type is gate_type_t
+     * \return const char*, one of the *_GATE_T keywords
+     *
+     */
+    const char *GateTypeName(gate_type_t gate_type);
+
+    /**
+     * \struct bench_node_type
+     * \brief Struct that represents one statement of a bench file.
+     *
+     */
+    struct bench_node_type {
+        label_id_t label;                         ///< Label of the node
+        gate_type_t gate_type;                    ///< Type of the gate
+        std::vector<label_id_t> input_node_list;  ///< Labels of the inputs of the gate in file order
+    };
+
+    /**
+     * \class LabelPool
+     *
+     * \brief Stores every distinct label once and numbers the labels densely.
+     *
+     */
+    class LabelPool {
+    public:
+        /**
+         * \brief return the index of the label, adding it if it is new.
+         * \param label is std::string_view, it is copied only on its first occurrence
+         * \return label_id_t
+         *
+         */
+        label_id_t Intern(std::string_view label);
+
+        /**
+         * \brief search a label without adding it.
+         * \param label is std::string_view
+         * \param id is set to the index of the label if it exists
+         * \return true if the label exists
+         *
+         */
+        bool Find(std::string_view label, label_id_t &id) const;
+
+        /**
+         * \brief return the label with the given index.
+         * \param id is label_id_t
+         * \return const std::string&
+         *
+         */
+        const std::string &GetLabel(label_id_t id) const;
+
+        size_t Size() const;
+
+        void Clear();
+
+    private:
+        std::deque<std::string> labels; ///< deque, so the views in ids stay valid while it grows
+        std::unordered_map<std::string_view, label_id_t> ids;
+    };
+
+    /**
+     * \class MappedFile
+     *
+     * \brief Read-only memory mapping of a whole file.
+     *
+     */
+    class MappedFile {
+    public:
+        /**
+         * \brief Maps the file into memory.
+         * \param path is the path of the file
+         *
+         * Throws a std::runtime_error if the file cannot be opened or mapped.
+         */
+        explicit MappedFile(const std::string &path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        /**
+         * \brief return the content of the file, valid as long as the MappedFile exists.
+         * \param none
+         * \return std::string_view
+         *
+         */
+        std::string_view GetText() const;
+
+    private:
+        const char *data = nullptr;
+        size_t size = 0;
+    };
+
+    /**
+     * \class BenchLexer
+     *
+     * \brief Splits bench format text into statements.
+     *
+     *  The text is scanned once without copying. Blanks, empty lines and
+     *  comments starting with '#' are skipped. Each statement is one of
+     *      INPUT(a)
+     *      OUTPUT(a)
+     *      a = NOT(b)            (also BUFF and DFF, exactly one input)
+     *      a = AND(b, c, ...)    (also OR, NAND, NOR and XOR, at least two inputs)
+     *  and must end with its line.
+     *
+     */
+    class BenchLexer {
+    public:
+        /**
+         * \brief Constructor
+         * \param text is the bench format text, which must outlive the lexer
+         * \param labels is the pool receiving the labels of all statements
+         *
+         */
+        BenchLexer(std::string_view text, LabelPool &labels);
+
+        /**
+         * \brief skips to the beginning of the next statement.
+         * \param none
+         * \return false if the end of the text is reached
+         *
+         */
+        bool NextStatement();
+
+        /**
+         * \brief parses the statement at the current position.
+         * \param node is overwritten with the parsed statement
+         * \return false in case of a syntax error
+         *
+         */
+        bool ParseStatement(bench_node_type &node);
+
+        /**
+         * \brief return the number of the current line, starting at 1.
+         * \param none
+         * \return size_t
+         *
+         */
+        size_t GetLine() const;
+
+        /**
+         * \brief return the text of the current line, for error messages.
+         * \param none
+         * \return std::string_view
+         *
+         */
+        std::string_view GetCurrentLine() const;
+
+    private:
+        std::string_view text;
+        size_t pos = 0;
+        size_t line = 1;
+        size_t line_start = 0;
+        LabelPool &labels;
+
+        void SkipBlanks();
+
+        bool Accept(char c);
+
+        bool ReadIdentifier(std::string_view &identifier);
+
+        bool ReadInputList(bench_node_type &node);
+    };
+}
@@ -5,14 +5,28 @@
 
 #include "BenchParser.hpp"
 
-BenchParser::BenchParser(const std::string &bench_file) {
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+BenchParser::BenchParser(const std::string &bench_file, bool use_cache) {
 
     id_counter = 0;
 
+    const std::string cache_file = GetCacheFileName(bench_file);
+    circuit_cache_key_t cache_key{};
+    /* A file that cannot be stat'ed is parsed without the cache */
+    use_cache = use_cache && GetCacheKey(bench_file, cache_key);
+    if (use_cache && loadCircuitCache(cache_file, cache_key)) {
+        std::cout << std::endl << "- Loaded sorted circuit from '" << cache_file << "'" << std::endl;
+        return;
+    }
+
     if (parseFile(bench_file)) {
         /* Based on the list of output labels, generate the corresponding circuit */
         std::cout << "- Creating circuit from bench nodes... ";
         createCircuitFromOutputList();
+        BuildAdjacency();
         std::cout << "Done!" << std::endl;
 
         /* Sort the circuit */
@@ -22,11 +36,16 @@ BenchParser::BenchParser(const std::string &bench_file) {
 
         label_to_node.clear();
         labels_to_id.clear();
-        id_to_circuit_node.clear();
+        circuit_edges.clear();
+        circuit_edges.shrink_to_fit();
         output_labels.clear();
         ff_labels.clear();
         output_circuits.clear();
         input_circuits.clear();
+
+        if (use_cache && !writeCircuitCache(cache_file, cache_key)) {
+            std::cout << "- Could not write circuit cache '" << cache_file << "'" << std::endl;
+        }
     } else {
         throw std::runtime_error("Please check bench file syntax!");
     }
@@ -39,39 +58,37 @@ BenchParser::~BenchParser() = default;
  * ---------------
  */
 void BenchParser::PrintLabelsTable() {
-    std::unordered_map<label_t, bench_node_t>::const_iterator it_label;
+    std::unordered_map<label_key_t, bench_node_t>::const_iterator it_label;
 
     std::cout << "============ [BEGIN] Table of Labels and Nodes ============" << std::endl;
     std::cout << std::endl << "-----" << std::endl;
     for (it_label = label_to_node.begin(); it_label != label_to_node.end(); it_label++) {
-        std::cout << std::endl << "Label: " << it_label->first << std::endl;
+        std::cout << std::endl << "Label: " << KeyToLabel(it_label->first) << std::endl;
         std::cout << "Node Information:" << std::endl;
-        std::cout << "\tNode Label: " << it_label->second.label << std::endl;
-        std::cout << "\tGate Type: " << it_label->second.gate_type << std::endl;
+        std::cout << "\tNode Label: " << labels.GetLabel(it_label->second.label) << std::endl;
+        std::cout << "\tGate Type: " << bench_format::GateTypeName(it_label->second.gate_type) << std::endl;
         std::cout << "\tInputs: ";
         for (const auto &i : it_label->second.input_node_list)
-            std::cout << i << ' ';
+            std::cout << labels.GetLabel(i) << ' ';
         std::cout << std::endl << "-----" << std::endl;
     }
     std::cout << "============ [END] Table of Labels and Nodes ============" << std::endl;
 }
 
 void BenchParser::PrintUUIDCircuitTable() {
-    std::unordered_map<unique_ID_t, circuit_node_t>::const_iterator it_uuid;
-
     std::cout << "============ [BEGIN] Table of Labels and Nodes ============" << std::endl;
     std::cout << std::endl << "-----" << std::endl;
-    for (it_uuid = id_to_circuit_node.begin(); it_uuid != id_to_circuit_node.end(); it_uuid++) {
-        std::cout << std::endl << "UUID: " << it_uuid->first << std::endl;
+    for (const auto &circuit_node : circuit_nodes) {
+        std::cout << std::endl << "UUID: " << circuit_node.id << std::endl;
         std::cout << "Node Information:" << std::endl;
-        std::cout << "\tNode Circuit Label: " << it_uuid->second.label << std::endl;
-        std::cout << "\tGate Type: " << it_uuid->second.gate_type << std::endl;
+        std::cout << "\tNode Circuit Label: " << circuit_node.label << std::endl;
+        std::cout << "\tGate Type: " << bench_format::GateTypeName(circuit_node.gate_type) << std::endl;
         std::cout << "\tInputs: ";
-        for (unsigned long i : it_uuid->second.input_id_list)
+        for (unsigned long i : circuit_node.input_id_list)
             std::cout << i << ' ';
         std::cout << std::endl << "-----" << std::endl;
         std::cout << "\tOutputs: ";
-        for (unsigned long i : it_uuid->second.output_id_list)
+        for (unsigned long i : circuit_node.output_id_list)
             std::cout << i << ' ';
         std::cout << std::endl << "-----" << std::endl;
     }
@@ -79,24 +96,22 @@ void BenchParser::PrintUUIDCircuitTable() {
 }
 
 void BenchParser::PrintOutputList() {
-    std::set<label_t>::const_iterator it;
-
     std::cout << std::endl << "============ [BEGIN] List of Outputs ============" << std::endl << std::endl;
     std::cout << std::endl << "List of output labels: ";
-    for (it = output_labels.begin(); it != output_labels.end(); it++) {
-        std::cout << (*it) << " -> ";
+    for (const auto &output_label : output_labels) {
+        std::cout << labels.GetLabel(output_label) << " -> ";
     }
     std::cout << "end;" << std::endl;
     std::cout << std::endl << "============ [END] List of Outputs ============" << std::endl;
 }
 
 void BenchParser::PrintLabels2UUIDTable() {
-    std::unordered_map<label_t, unique_ID_t>::const_iterator it_label;
+    std::unordered_map<label_key_t, unique_ID_t>::const_iterator it_label;
 
     std::cout << "============ [BEGIN] Table of Labels and UUIDs ============" << std::endl;
     std::cout << std::endl << "-----" << std::endl;
     for (it_label = labels_to_id.begin(); it_label != labels_to_id.end(); it_label++) {
-        std::cout << std::endl << "Label: " << it_label->first << std::endl;
+        std::cout << std::endl << "Label: " << KeyToLabel(it_label->first) << std::endl;
         std::cout << std::endl << "UUID: " << it_label->second << std::endl;
         std::cout << std::endl << "------------------------------" << std::endl;
     }
@@ -104,15 +119,11 @@ void BenchParser::PrintLabels2UUIDTable() {
 }
 
 void BenchParser::PrintCircuit(unique_ID_t circuit_ID, int indent) {
-    std::unordered_map<unique_ID_t, circuit_node_t>::const_iterator got;
-    circuit_node_t node;
-
-    got = (id_to_circuit_node).find(circuit_ID);
-    if (got != id_to_circuit_node.end()) {
-        node = got->second;
+    if (circuit_ID < circuit_nodes.size()) {
+        const circuit_node_t &node = circuit_nodes[circuit_ID];
         std::cout << std::string(indent, ' ') << "Node ID: " << node.id << std::endl;
         std::cout << std::string(indent, ' ') << "Label: " << node.label << std::endl;
-        std::cout << std::string(indent, ' ') << "Type: " << node.gate_type << std::endl;
+        std::cout << std::string(indent, ' ') << "Type: " << bench_format::GateTypeName(node.gate_type) << std::endl;
 
         std::cout << std::string(indent, ' ') << "Input List: " << std::endl;
         for (unsigned long i : node.input_id_list)
@@ -131,15 +142,42 @@ void BenchParser::PrintCircuit(unique_ID_t circuit_ID, int indent) {
 }
 
 void BenchParser::PrintCircuitByLabel(const label_t &node_label) {
-    std::unordered_map<label_t, unique_ID_t>::const_iterator got;
+    std::unordered_map<label_key_t, unique_ID_t>::const_iterator got;
+    label_id_t label_id;
+
+    if (labels.Find(node_label, label_id)) {
+        got = (labels_to_id).find(LabelKey(label_id));
+        if (got != labels_to_id.end()) {
+            PrintCircuit(got->second, 0);
+            return;
+        }
+    }
+    throw std::runtime_error("There is no mapping from this label to a circuit node.");
+}
 
-    got = (labels_to_id).find(node_label);
-    if (got != labels_to_id.end()) {
-        PrintCircuit(got->second, 0);
-    } else {
-        throw std::runtime_error("There is no mapping from this label to a circuit node.");
+label_key_t BenchParser::LabelKey(label_id_t label, gate_type_t gate_type) {
+    if (gate_type == gate_type_t::Output) {
+        return 3 * label + 1;
+    } else if (gate_type == gate_type_t::FlipFlop) {
+        return 3 * label + 2;
     }
+    return 3 * label;
+}
 
+label_t BenchParser::KeyToLabel(label_key_t key) {
+    const label_t &label = labels.GetLabel(key / 3);
+    if (key % 3 == 1) {
+        return label + OUTPUT_GATE_T;
+    } else if (key % 3 == 2) {
+        return label + FLIP_FLOP_GATE_T;
+    }
+    return label;
+}
+
+void BenchParser::SortByLabel(std::vector<label_id_t> &label_ids) {
+    std::sort(label_ids.begin(), label_ids.end(), [this](label_id_t a, label_id_t b) {
+        return labels.GetLabel(a) < labels.GetLabel(b);
+    });
 }
 
 
@@ -150,17 +188,12 @@ void BenchParser::PrintCircuitsOfOutputSet() {
 }
 
 void BenchParser::PrintSortedCircuitList() {
-    list_of_circuit_t::const_iterator it;
-
     std::cout << std::endl << "============ [BEGIN] List of Sorted Circuit Nodes ============" << std::endl
               << std::endl;
     std::cout << std::endl << "List of Sorted Circuit Nodes labels: ";
 
-    list_of_circuit_t ordered_circuit = this->GetSortedCircuit();
-
-
-    for (it = ordered_circuit.begin(); it != ordered_circuit.end(); it++) {
-        std::cout << (*it).id << " -> ";
+    for (const auto &circuit_node : this->GetSortedCircuit()) {
+        std::cout << circuit_node.id << " -> ";
     }
     std::cout << "end;" << std::endl;
     std::cout << std::endl << "============ [END] List of Sorted Circuit Nodes ============" << std::endl;
@@ -184,28 +217,37 @@ std::set<label_t> BenchParser::GetListOfOutputLabels() {
     return outputs;
 }
 
+std::vector<label_t> BenchParser::GetListOfInputLabels() {
+    return input_labels;
+}
 
-circuit_node_t BenchParser::GetCircuitNode(unique_ID_t circuit_node_uuid) {
-    /* Iterator for the uuid2circuitNode_table table */
-    std::unordered_map<unique_ID_t, circuit_node_t>::const_iterator got;
+std::vector<std::pair<label_t, label_t>> BenchParser::GetListOfFlipFlops() {
+    return flip_flops;
+}
 
-    /* Search the node and add the UUID of the current node to this node OUTPUT_LIST */
-    got = id_to_circuit_node.find(circuit_node_uuid);
 
-    if (got != id_to_circuit_node.end()) {
-        return got->second;
-    }//if
-    else {
+const circuit_node_t &BenchParser::GetCircuitNode(unique_ID_t circuit_node_uuid) {
+    if (circuit_node_uuid < circuit_nodes.size()) {
+        return circuit_nodes[circuit_node_uuid];
+    } else {
         throw std::runtime_error("There is no mapping from this unique_ID_t to a circuit_node_type.");
     }
 }
 
-std::unordered_map<unique_ID_t, circuit_node_t> BenchParser::GetCircuit() {
-    return id_to_circuit_node;
+sorted_circuit_t BenchParser::GetSortedCircuit() {
+    return sorted_circuit_t(circuit_nodes.data(), circuit_nodes.size());
 }
 
-list_of_circuit_t BenchParser::GetSortedCircuit() {
-    return sorted_circuit;
+size_t BenchParser::GetNumberOfLevels() {
+    return level_offsets.empty() ? 0 : level_offsets.size() - 1;
+}
+
+sorted_circuit_t BenchParser::GetLevel(size_t level) {
+    if (level >= GetNumberOfLevels()) {
+        throw std::runtime_error("There is no such topological level in the circuit.");
+    }
+    return sorted_circuit_t(circuit_nodes.data() + level_offsets[level],
+                            level_offsets[level + 1] - level_offsets[level]);
 }
 
 /* --------------- 
@@ -214,40 +256,54 @@ list_of_circuit_t BenchParser::GetSortedCircuit() {
  */
 bool BenchParser::parseFile(const std::string &bench_file) {
 
-    std::cout << std::endl << "- Reading bench format file... ";
-    std::ifstream in(bench_file);
-    if (!in.is_open()) {
-        throw std::runtime_error("Could not open file: " + bench_file);
+    const std::string extension = std::filesystem::path(bench_file).extension().string();
+    if ((extension == ".aag") || (extension == ".aig")) {
+        return parseAigerFile(bench_file);
     }
-    in.unsetf(std::ios::skipws);
-    std::cout << "Done!" << std::endl;
-
-    /* Declaring file iterators */
-    boost::spirit::istream_iterator first(in), last;
 
-    /* Declaring skip parser to be used */
-    skip_p::skip_grammar<boost::spirit::istream_iterator> skip;
+    std::cout << std::endl << "- Reading bench format file... ";
+    bench_format::MappedFile file(bench_file);
+    std::cout << "Done!" << std::endl;
 
-    /* Declaring bench format grammar */
-    bench_format::bench_parser<boost::spirit::istream_iterator> bench_grammar_parser;
+    /* Tokens are views into the mapped file, labels are copied once into the label pool */
+    bench_format::BenchLexer lexer(file.GetText(), labels);
 
     /* Stored result after parsing a file line */
-    bench_format::bench_node_type parsed_bench_node;
+    bench_node_t parsed_bench_node;
 
     /* Effectively parsing the file. The parser returns a benchnode to be added to the labels table */
     std::cout << "- Parsing input file '" << bench_file << "'... ";
-    bool successfully_parsed;
-    do {
-        successfully_parsed = phrase_parse(first, last, bench_grammar_parser, skip, parsed_bench_node);
-        if (!successfully_parsed) {
-            std::cout << "Failed parsing input file at: " << std::string(first, last) << std::endl;
+    while (lexer.NextStatement()) { /* Operations are performed until it is EOF */
+        if (!lexer.ParseStatement(parsed_bench_node)) {
+            std::cout << "Failed parsing input file at line " << lexer.GetLine() << ": "
+                      << lexer.GetCurrentLine() << std::endl;
             return false;
-        } else {
-            /* Add the successfully read bench node into the labels table */
-            addToLabelTable(parsed_bench_node);
         }
-        parsed_bench_node = bench_format::bench_node_type();
-    } while (first != last); /* Operations are performed until it is EOF */
+        /* Add the successfully read bench node into the labels table */
+        addToLabelTable(parsed_bench_node);
+    }
+    std::cout << "Done!" << std::endl;
+
+    return true;
+}
+
+bool BenchParser::parseAigerFile(const std::string &aiger_file) {
+
+    std::cout << std::endl << "- Reading AIGER file... ";
+    bench_format::MappedFile file(aiger_file);
+    std::cout << "Done!" << std::endl;
+
+    bench_format::AigerReader reader(file.GetText(), labels);
+    std::vector<bench_node_t> statements;
+
+    std::cout << "- Parsing input file '" << aiger_file << "'... ";
+    if (!reader.ReadStatements(statements)) {
+        std::cout << "Failed parsing input file: " << reader.GetError() << std::endl;
+        return false;
+    }
+    for (auto &statement : statements) {
+        addToLabelTable(std::move(statement));
+    }
     std::cout << "Done!" << std::endl;
 
     return true;
@@ -256,7 +312,7 @@ bool BenchParser::parseFile(const std::string &bench_file) {
 
 bool BenchParser::addToLabelTable(bench_node_t bench_node) {
     bool new_node_added;
-    label_t search_label;
+    label_key_t search_key;
     /*
      * Output nodes have to be handle a bit different, since they'll have
      *  the same label as another gate. Mappings require unique element
@@ -264,21 +320,19 @@ bool BenchParser::addToLabelTable(bench_node_t bench_node) {
      *  original label concatenated with the string "OUTPUT" to differentiate
      *  from the other gate that has the same label.
     */
-    if (bench_node.gate_type == OUTPUT_GATE_T) {
-        /* If the gate is an output gate, it must be included into the set_of_output_labels */
-        output_labels.insert(bench_node.label);
-        search_label = bench_node.label + bench_node.gate_type;
+    if (bench_node.gate_type == gate_type_t::Output) {
+        search_key = LabelKey(bench_node.label, bench_node.gate_type);
     } else {
-        search_label = bench_node.label;
+        search_key = LabelKey(bench_node.label);
     }
 
-    if (label_to_node.find(search_label) != label_to_node.end()) {
+    if (label_to_node.find(search_key) != label_to_node.end()) {
         new_node_added = false;
     } else {
         /*
          * Otherwise add bench_node to the labels_table
          */
-        if (bench_node.gate_type == FLIP_FLOP_GATE_T) {
+        if (bench_node.gate_type == gate_type_t::FlipFlop) {
 
             /* If it is a flip flop, we have to add two nodes:
                One that will be the output node;
@@ -289,12 +343,20 @@ bool BenchParser::addToLabelTable(bench_node_t bench_node) {
                label as the flip flop, and another one with the "FLIP_FLOP_GATE_T"
                string concatenated. So if we search for one of them, it is
                enough to check whether the node exists or not. */
-            ff_labels.insert(search_label);
-            label_to_node.insert(std::pair<label_t, bench_node_t>(search_label + FLIP_FLOP_GATE_T, bench_node));
-            bench_node.gate_type = INPUT_GATE_T;
+            ff_labels.push_back(bench_node.label);
+            flip_flops.emplace_back(labels.GetLabel(bench_node.label),
+                                    labels.GetLabel(bench_node.input_node_list.front()));
+            label_to_node.insert(std::pair<label_key_t, bench_node_t>(
+                    LabelKey(bench_node.label, gate_type_t::FlipFlop), bench_node));
+            bench_node.gate_type = gate_type_t::Input;
             bench_node.input_node_list.clear();
+        } else if (bench_node.gate_type == gate_type_t::Input) {
+            input_labels.push_back(labels.GetLabel(bench_node.label));
+        } else if (bench_node.gate_type == gate_type_t::Output) {
+            /* If the gate is an output gate, it must be included into the set_of_output_labels */
+            output_labels.push_back(bench_node.label);
         }
-        label_to_node.insert(std::pair<label_t, bench_node_t>(search_label, bench_node));
+        label_to_node.insert(std::pair<label_key_t, bench_node_t>(search_key, bench_node));
         new_node_added = true;
     }
     return new_node_added;
@@ -303,17 +365,12 @@ bool BenchParser::addToLabelTable(bench_node_t bench_node) {
 unique_ID_t BenchParser::findOrAddToCircuit(const bench_node_t &bench_node) {
 
     unique_ID_t CircuitNodeID;
-    std::unordered_map<label_t, unique_ID_t>::const_iterator got;
-    circuit_node_t new_circuit_node;
-    label_t search_label;
+    std::unordered_map<label_key_t, unique_ID_t>::const_iterator got;
+    label_key_t search_key;
 
-    if ((bench_node.gate_type == OUTPUT_GATE_T) || (bench_node.gate_type == FLIP_FLOP_GATE_T)) {
-        search_label = bench_node.label + bench_node.gate_type;
-    } else {
-        search_label = bench_node.label;
-    }
+    search_key = LabelKey(bench_node.label, bench_node.gate_type);
 
-    got = labels_to_id.find(search_label);
+    got = labels_to_id.find(search_key);
 
     if (got != labels_to_id.end()) {
         /* If the iterator is not pointing to the end of the labels_table,
@@ -324,18 +381,16 @@ unique_ID_t BenchParser::findOrAddToCircuit(const bench_node_t &bench_node) {
         /*
          * Otherwise add bench_node to the labels_table and returns its UUID
          */
-        new_circuit_node = benchNodeToCircuitNode(bench_node);
-        CircuitNodeID = new_circuit_node.id;
-        labels_to_id.insert(std::pair<label_t, unique_ID_t>(search_label, CircuitNodeID));
-        id_to_circuit_node.insert(std::pair<unique_ID_t, circuit_node_t>(CircuitNodeID, new_circuit_node));
+        CircuitNodeID = benchNodeToCircuitNode(bench_node);
+        labels_to_id.insert(std::pair<label_key_t, unique_ID_t>(search_key, CircuitNodeID));
     }
     return CircuitNodeID;
 }
 
 
-unique_ID_t BenchParser::findOrAddToCircuitByLabel(const label_t &node_label) {
+unique_ID_t BenchParser::findOrAddToCircuitByLabel(label_key_t node_key) {
 
-    auto label = (label_to_node).find(node_label);
+    auto label = (label_to_node).find(node_key);
 
     if (label != label_to_node.end()) {
         return (findOrAddToCircuit(label->second));
@@ -344,131 +399,463 @@ unique_ID_t BenchParser::findOrAddToCircuitByLabel(const label_t &node_label) {
     }
 }
 
-circuit_node_t BenchParser::benchNodeToCircuitNode(const bench_node_t &bench_node) {
+unique_ID_t BenchParser::benchNodeToCircuitNode(const bench_node_t &bench_node) {
 
-    circuit_node_t new_circuit_node;
     size_t input_id, new_id;
 
     /* Generate an unique identifier */
-    new_circuit_node.id = id_counter;
+    new_id = id_counter;
     id_counter++;
-    new_id = new_circuit_node.id;
 
-    new_circuit_node.label = bench_node.label;
+    circuit_node_t new_circuit_node{};
+    new_circuit_node.id = new_id;
+    new_circuit_node.label = labels.GetLabel(bench_node.label);
     new_circuit_node.gate_type = bench_node.gate_type;
+    circuit_nodes.push_back(new_circuit_node);
 
     /* If it is not an INPUT gate, we have to recursively iterate to get the unique id of the inputs */
-    if (!(new_circuit_node.gate_type == INPUT_GATE_T)) {
+    if (!(bench_node.gate_type == gate_type_t::Input)) {
 
-        if (new_circuit_node.gate_type == OUTPUT_GATE_T) {
+        if (bench_node.gate_type == gate_type_t::Output) {
 
-            input_id = findOrAddToCircuitByLabel(bench_node.label);
-            new_circuit_node.input_id_list.insert(input_id);
-
-            auto node = id_to_circuit_node.find(input_id);
-            if (node != id_to_circuit_node.end()) {
-                node->second.output_id_list.insert(new_id);
-            }
+            input_id = findOrAddToCircuitByLabel(LabelKey(bench_node.label));
+            circuit_edges.emplace_back(new_id, input_id);
 
         } else {
 
             for (const auto &input_node : bench_node.input_node_list) {
 
-                input_id = findOrAddToCircuitByLabel(input_node);
-                new_circuit_node.input_id_list.insert(input_id);
-
-                auto node = id_to_circuit_node.find(input_id);
-                if (node != id_to_circuit_node.end()) {
-                    node->second.output_id_list.insert(new_id);
-                }
+                input_id = findOrAddToCircuitByLabel(LabelKey(input_node));
+                circuit_edges.emplace_back(new_id, input_id);
             }
         }
     } else {
         input_circuits.insert(new_id);
     }
 
-    return new_circuit_node;
+    return new_id;
 }
 
 
 void BenchParser::createCircuitFromOutputList() {
 
-    std::set<label_t>::const_iterator it;
-    std::unordered_map<label_t, unique_ID_t>::const_iterator got_uid;
-    std::unordered_map<unique_ID_t, circuit_node_t>::const_iterator got_node;
+    /* Circuit IDs are handed out in alphabetical order of the outputs */
+    SortByLabel(output_labels);
+    SortByLabel(ff_labels);
 
     for (const auto &output_label : output_labels) {
-        createCircuitByLabel(output_label + OUTPUT_GATE_T);
+        createCircuitByLabel(LabelKey(output_label, gate_type_t::Output));
     }
     for (const auto &ff_label : ff_labels) {
-        createCircuitByLabel(ff_label + FLIP_FLOP_GATE_T);
+        createCircuitByLabel(LabelKey(ff_label, gate_type_t::FlipFlop));
     }
     for (const auto &ff_label : ff_labels) {
-        auto ff_id = labels_to_id.find(ff_label + FLIP_FLOP_GATE_T);
-        auto ff_node = id_to_circuit_node.find(ff_id->second);
-        ff_node = id_to_circuit_node.find(*(ff_node->second).input_id_list.begin());
-        outputs.insert(ff_node->second.label);
+        /* The data input of a FLIP FLOP is the only input of its DFF node */
+        const bench_node_t &ff_node = label_to_node.at(LabelKey(ff_label, gate_type_t::FlipFlop));
+        outputs.insert(labels.GetLabel(ff_node.input_node_list.front()));
     }
-    outputs.insert(output_labels.begin(), output_labels.end());
+    for (const auto &output_label : output_labels) {
+        outputs.insert(labels.GetLabel(output_label));
+    }
+
+    /* The inputs of a gate are a set: ascending and without duplicates */
+    std::sort(circuit_edges.begin(), circuit_edges.end());
+    circuit_edges.erase(std::unique(circuit_edges.begin(), circuit_edges.end()), circuit_edges.end());
 }
 
-void BenchParser::createCircuitByLabel(const label_t &bnode_label) {
+void BenchParser::createCircuitByLabel(label_key_t bnode_key) {
     unique_ID_t new_circuit;
-    new_circuit = findOrAddToCircuitByLabel(bnode_label);
+    new_circuit = findOrAddToCircuitByLabel(bnode_key);
     output_circuits.insert(new_circuit);
 }
 
 
+/* -----------------------------
+ * Circuit graph
+ * -----------------------------
+ */
+void BenchParser::BuildAdjacency() {
+    const size_t node_count = circuit_nodes.size();
+
+    /* Count the edges of every node, then place them with a counting sort */
+    input_offsets.assign(node_count + 1, 0);
+    output_offsets.assign(node_count + 1, 0);
+    for (const auto &edge : circuit_edges) {
+        input_offsets[edge.first + 1]++;
+        output_offsets[edge.second + 1]++;
+    }
+    for (size_t i = 0; i < node_count; i++) {
+        input_offsets[i + 1] += input_offsets[i];
+        output_offsets[i + 1] += output_offsets[i];
+    }
+
+    input_ids.resize(circuit_edges.size());
+    output_ids.resize(circuit_edges.size());
+    std::vector<size_t> input_end(input_offsets.begin(), input_offsets.end() - 1);
+    std::vector<size_t> output_end(output_offsets.begin(), output_offsets.end() - 1);
+    for (const auto &edge : circuit_edges) {
+        input_ids[input_end[edge.first]++] = edge.second;
+    }
+    for (unique_ID_t node = 0; node < node_count; node++) {
+        for (size_t i = input_offsets[node]; i < input_offsets[node + 1]; i++) {
+            output_ids[output_end[input_ids[i]]++] = node;
+        }
+    }
+
+    for (auto &circuit_node : circuit_nodes) {
+        const unique_ID_t id = circuit_node.id;
+        circuit_node.input_id_list = span_t<unique_ID_t>(input_ids.data() + input_offsets[id],
+                                                         input_offsets[id + 1] - input_offsets[id]);
+        circuit_node.output_id_list = span_t<unique_ID_t>(output_ids.data() + output_offsets[id],
+                                                          output_offsets[id + 1] - output_offsets[id]);
+    }
+}
+
+void BenchParser::RenumberCircuit(const std::vector<unique_ID_t> &order) {
+    std::vector<unique_ID_t> new_id(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        new_id[order[i]] = i;
+    }
+
+    /* The inputs of a node stay in their order, since BuildAdjacency() keeps the order of the edges */
+    circuit_edges.clear();
+    std::vector<circuit_node_t> renumbered_nodes(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        renumbered_nodes[i] = circuit_nodes[order[i]];
+        renumbered_nodes[i].id = i;
+        for (unique_ID_t input : circuit_nodes[order[i]].input_id_list) {
+            circuit_edges.emplace_back(i, new_id[input]);
+        }
+    }
+    circuit_nodes.swap(renumbered_nodes);
+    BuildAdjacency();
+
+    set_of_circuit_t renumbered_circuits;
+    for (unique_ID_t id : output_circuits) {
+        renumbered_circuits.insert(new_id[id]);
+    }
+    output_circuits.swap(renumbered_circuits);
+
+    renumbered_circuits.clear();
+    for (unique_ID_t id : input_circuits) {
+        renumbered_circuits.insert(new_id[id]);
+    }
+    input_circuits.swap(renumbered_circuits);
+}
+
+
 /* -----------------------------
  * Topological Sort Algorithms
  * -----------------------------
  */
 void BenchParser::TopologicalSortKahnsAlgorithm() {
-    set_of_circuit_t nodes_without_outgoing_edges = GetListOfCircuitsOutputs();
-    set_of_circuit_t::iterator it;
-
-    circuit_node_t node, tmp_node;
-
-    while (!nodes_without_outgoing_edges.empty()) {
-        it = nodes_without_outgoing_edges.begin();
-        /* Always pick the first element of the list of nodes without incoming edges */
-        node = GetCircuitNode(*it);
-        nodes_without_outgoing_edges.erase(it);
-
-        /* Nodes are added always to the end of the list */
-        sorted_circuit.push_front(node);
-        for (auto it_input_nodes = node.input_id_list.begin();
-             it_input_nodes != node.input_id_list.end(); it_input_nodes++) {
-            if (IsUniqueOutgoingEdge(*it_input_nodes, node.id)) {
-                nodes_without_outgoing_edges.insert(*it_input_nodes);
+    const size_t node_count = circuit_nodes.size();
+
+    /* Number of inputs that are not sorted yet */
+    std::vector<size_t> remaining_inputs(node_count);
+    for (const auto &circuit_node : circuit_nodes) {
+        remaining_inputs[circuit_node.id] = circuit_node.input_id_list.size();
+    }
+
+    /* Level 0 starts with the INPUT gates in the order of the INPUT lines, followed by
+       the other nodes without inputs (FLIP FLOP outputs, constants) in circuit order.
+       The variable order is left to VariableOrder. */
+    std::vector<unique_ID_t> sorted_ids;
+    std::vector<bool> seeded(node_count, false);
+    sorted_ids.reserve(node_count);
+    for (const auto &input_label : input_labels) {
+        label_id_t label_id;
+        if (labels.Find(input_label, label_id)) {
+            auto got = labels_to_id.find(LabelKey(label_id));
+            /* INPUT gates outside every output cone are not part of the circuit */
+            if ((got != labels_to_id.end()) && !seeded[got->second]) {
+                sorted_ids.push_back(got->second);
+                seeded[got->second] = true;
             }
         }
     }
+    for (const auto &circuit_node : circuit_nodes) {
+        if (circuit_node.input_id_list.empty() && !seeded[circuit_node.id]) {
+            sorted_ids.push_back(circuit_node.id);
+        }
+    }
 
-    if (sorted_circuit.size() != id_to_circuit_node.size()) {
+    /* sorted_ids doubles as the queue. A node is appended once its last input
+       is sorted, so it lies one level above its highest input. Processing a
+       whole level before the next one keeps every level contiguous. */
+    std::vector<size_t> node_level(node_count, 0);
+    level_offsets.clear();
+    size_t level_begin = 0;
+    while (level_begin < sorted_ids.size()) {
+        const size_t level_end = sorted_ids.size();
+        level_offsets.push_back(level_begin);
+
+        for (size_t i = level_begin; i < level_end; i++) {
+            for (unique_ID_t output : circuit_nodes[sorted_ids[i]].output_id_list) {
+                if (--remaining_inputs[output] == 0) {
+                    node_level[output] = level_offsets.size();
+                    sorted_ids.push_back(output);
+                }
+            }
+        }
+        level_begin = level_end;
+    }
+    level_offsets.push_back(sorted_ids.size());
+
+    if (sorted_ids.size() != node_count) {
         throw std::runtime_error("The circuit must be cycle free!");
     }
+
+    for (auto &circuit_node : circuit_nodes) {
+        circuit_node.level = node_level[circuit_node.id];
+    }
+    RenumberCircuit(sorted_ids);
 }
 
 
 /* -----------------------------
- * Auxiliary functions for
- * Topological Sort Algorithms
+ * Circuit Cache
  * -----------------------------
  */
+namespace {
+    /* Layout of a cache file:
+     *   header
+     *   path:     canonical path of the bench file
+     *   strings:  string_count + 1 offsets into the characters, then the characters
+     *             (node labels, output labels, input labels, then the FLIP FLOP label pairs)
+     *   nodes:    gate type and level of every node
+     *   graph:    input_offsets, input_ids, output_offsets, output_ids, level_offsets
+     * All numbers are uint64_t in native byte order. The version changes with the layout.
+     * The header holds a hash of everything after it, so a damaged cache is rebuilt.
+     */
+    constexpr char CACHE_MAGIC[8] = {'V', 'D', 'S', 'C', 'I', 'R', 'C', '\0'};
+    constexpr uint64_t CACHE_VERSION = 5;
+
+    struct cache_header_t {
+        char magic[8];
+        uint64_t version;
+        uint64_t file_size;
+        int64_t file_time;
+        uint64_t path_size;
+        uint64_t node_count;
+        uint64_t edge_count;
+        uint64_t level_count;
+        uint64_t output_count;
+        uint64_t input_count;
+        uint64_t flip_flop_count;
+        uint64_t char_count;
+        uint64_t payload_hash;
+    };
+
+    /* 64-bit FNV-1a */
+    uint64_t HashBytes(std::string_view bytes) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (char c : bytes) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+        }
+        return hash;
+    }
 
-bool BenchParser::IsUniqueOutgoingEdge(unique_ID_t src_node, unique_ID_t dst_node) {
-    std::unordered_map<unique_ID_t, circuit_node_t>::iterator got;
+    template<typename T>
+    void AppendWords(std::string &payload, const std::vector<T> &words) {
+        for (T word : words) {
+            const auto value = static_cast<uint64_t>(word);
+            payload.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+    }
 
-    /* Search source node in the circuit graph */
-    got = id_to_circuit_node.find(src_node);
+    /* Reads count words, returns false if the file ends before */
+    bool ReadWords(std::string_view &data, size_t count, std::vector<uint64_t> &words) {
+        if (count > data.size() / sizeof(uint64_t)) {
+            return false;
+        }
+        words.resize(count);
+        std::memcpy(words.data(), data.data(), count * sizeof(uint64_t));
+        data.remove_prefix(count * sizeof(uint64_t));
+        return true;
+    }
+
+    /* Checks that offsets ascend from 0 to last */
+    bool ValidOffsets(const std::vector<uint64_t> &offsets, uint64_t last) {
+        return offsets.front() == 0 && offsets.back() == last && std::is_sorted(offsets.begin(), offsets.end());
+    }
+}
+
+std::string BenchParser::GetCacheFileName(const std::string &bench_file) {
+    const std::string name = std::filesystem::path(bench_file).stem().string();
+    return "results_" + name + "/" + name + ".circuit";
+}
 
-    if (got != id_to_circuit_node.end()) {
-        /* Remove outgoing edge to source node */
-        (got->second).output_id_list.erase((got->second).output_id_list.find(dst_node));
-        return (got->second).output_id_list.empty();
-    }//if
-    else {
-        throw std::runtime_error("Destination node UUID is not part of the circuit graph!");
+bool BenchParser::GetCacheKey(const std::string &bench_file, circuit_cache_key_t &key) {
+    std::error_code error;
+    key.source_path = std::filesystem::canonical(bench_file, error).string();
+    if (error) {
+        return false;
+    }
+    key.file_size = std::filesystem::file_size(bench_file, error);
+    if (error) {
+        return false;
+    }
+    key.file_time = std::filesystem::last_write_time(bench_file, error).time_since_epoch().count();
+    return !error;
+}
+
+bool BenchParser::loadCircuitCache(const std::string &cache_file, const circuit_cache_key_t &key) {
+    if (!std::filesystem::exists(cache_file)) {
+        return false;
+    }
+    bench_format::MappedFile file(cache_file);
+    std::string_view data = file.GetText();
+
+    cache_header_t header{};
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    data.remove_prefix(sizeof(header));
+
+    if ((std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) || (header.version != CACHE_VERSION) ||
+        (header.file_size != key.file_size) || (header.file_time != key.file_time) ||
+        (header.path_size != key.source_path.size()) || (data.substr(0, header.path_size) != key.source_path) ||
+        (HashBytes(data) != header.payload_hash)) {
+        return false;
+    }
+    data.remove_prefix(header.path_size);
+
+    const uint64_t node_count = header.node_count;
+    const uint64_t string_count = node_count + header.output_count + header.input_count + 2 * header.flip_flop_count;
+    std::vector<uint64_t> string_offsets, gate_types, node_levels;
+    std::vector<uint64_t> new_input_offsets, new_input_ids, new_output_offsets, new_output_ids, new_level_offsets;
+    if (!ReadWords(data, string_count + 1, string_offsets) || !ValidOffsets(string_offsets, header.char_count) ||
+        (data.size() < header.char_count)) {
+        return false;
+    }
+    const std::string_view chars = data.substr(0, header.char_count);
+    data.remove_prefix(header.char_count);
+
+    if (!ReadWords(data, node_count, gate_types) || !ReadWords(data, node_count, node_levels) ||
+        !ReadWords(data, node_count + 1, new_input_offsets) || !ReadWords(data, header.edge_count, new_input_ids) ||
+        !ReadWords(data, node_count + 1, new_output_offsets) || !ReadWords(data, header.edge_count, new_output_ids) ||
+        !ReadWords(data, header.level_count + 1, new_level_offsets) || !data.empty()) {
+        return false;
+    }
+    if (!ValidOffsets(new_input_offsets, header.edge_count) || !ValidOffsets(new_output_offsets, header.edge_count) ||
+        !ValidOffsets(new_level_offsets, node_count)) {
+        return false;
+    }
+    for (size_t i = 0; i < header.edge_count; i++) {
+        if ((new_input_ids[i] >= node_count) || (new_output_ids[i] >= node_count)) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < node_count; i++) {
+        if ((gate_types[i] > static_cast<uint64_t>(gate_type_t::Zero)) || (node_levels[i] >= header.level_count)) {
+            return false;
+        }
+    }
+
+    auto get_string = [&](size_t index) {
+        return chars.substr(string_offsets[index], string_offsets[index + 1] - string_offsets[index]);
+    };
+
+    input_offsets.assign(new_input_offsets.begin(), new_input_offsets.end());
+    input_ids.assign(new_input_ids.begin(), new_input_ids.end());
+    output_offsets.assign(new_output_offsets.begin(), new_output_offsets.end());
+    output_ids.assign(new_output_ids.begin(), new_output_ids.end());
+    level_offsets.assign(new_level_offsets.begin(), new_level_offsets.end());
+
+    circuit_nodes.resize(node_count);
+    for (size_t id = 0; id < node_count; id++) {
+        circuit_node_t &circuit_node = circuit_nodes[id];
+        circuit_node.id = id;
+        circuit_node.label = labels.GetLabel(labels.Intern(get_string(id)));
+        circuit_node.gate_type = static_cast<gate_type_t>(gate_types[id]);
+        circuit_node.level = node_levels[id];
+        circuit_node.input_id_list = span_t<unique_ID_t>(input_ids.data() + input_offsets[id],
+                                                         input_offsets[id + 1] - input_offsets[id]);
+        circuit_node.output_id_list = span_t<unique_ID_t>(output_ids.data() + output_offsets[id],
+                                                          output_offsets[id + 1] - output_offsets[id]);
+    }
+
+    size_t index = node_count;
+    for (size_t i = 0; i < header.output_count; i++) {
+        outputs.emplace(get_string(index++));
+    }
+    for (size_t i = 0; i < header.input_count; i++) {
+        input_labels.emplace_back(get_string(index++));
+    }
+    for (size_t i = 0; i < header.flip_flop_count; i++) {
+        const std::string_view flip_flop = get_string(index++);
+        flip_flops.emplace_back(flip_flop, get_string(index++));
+    }
+    return true;
+}
+
+bool BenchParser::writeCircuitCache(const std::string &cache_file, const circuit_cache_key_t &key) {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cache_file).parent_path(), error);
+
+    std::vector<std::string_view> strings;
+    for (const auto &circuit_node : circuit_nodes) {
+        strings.push_back(circuit_node.label);
+    }
+    strings.insert(strings.end(), outputs.begin(), outputs.end());
+    strings.insert(strings.end(), input_labels.begin(), input_labels.end());
+    for (const auto &flip_flop : flip_flops) {
+        strings.push_back(flip_flop.first);
+        strings.push_back(flip_flop.second);
+    }
+
+    std::vector<uint64_t> string_offsets{0};
+    std::string chars;
+    for (const auto &string : strings) {
+        chars.append(string);
+        string_offsets.push_back(chars.size());
+    }
+
+    std::vector<gate_type_t> gate_types;
+    std::vector<size_t> node_levels;
+    for (const auto &circuit_node : circuit_nodes) {
+        gate_types.push_back(circuit_node.gate_type);
+        node_levels.push_back(circuit_node.level);
+    }
+
+    std::string payload = key.source_path;
+    AppendWords(payload, string_offsets);
+    payload.append(chars);
+    AppendWords(payload, gate_types);
+    AppendWords(payload, node_levels);
+    AppendWords(payload, input_offsets);
+    AppendWords(payload, input_ids);
+    AppendWords(payload, output_offsets);
+    AppendWords(payload, output_ids);
+    AppendWords(payload, level_offsets.empty() ? std::vector<size_t>{0} : level_offsets);
+
+    cache_header_t header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.file_size = key.file_size;
+    header.file_time = key.file_time;
+    header.path_size = key.source_path.size();
+    header.node_count = circuit_nodes.size();
+    header.edge_count = input_ids.size();
+    header.level_count = GetNumberOfLevels();
+    header.output_count = outputs.size();
+    header.input_count = input_labels.size();
+    header.flip_flop_count = flip_flops.size();
+    header.char_count = chars.size();
+    header.payload_hash = HashBytes(payload);
+
+    const std::string temporary_file = cache_file + ".tmp";
+    {
+        std::ofstream out(temporary_file, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    }
+    if (std::filesystem::file_size(temporary_file, error) != sizeof(header) + payload.size()) {
+        std::filesystem::remove(temporary_file, error);
+        return false;
     }
+    std::filesystem::rename(temporary_file, cache_file, error);
+    return !error;
 }
@@ -5,11 +5,15 @@
 
 #pragma once
 
-#include "skip_parser.hpp"
-#include "bench_grammar.hpp"
+#include "AigerReader.hpp"
+#include "BenchLexer.hpp"
+#include <cstdint>
 #include <fstream>
-
-#include <boost/algorithm/string.hpp>
+#include <iostream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <unordered_map>
 #include <stdexcept>
@@ -17,37 +21,80 @@
 #include "BenchmarkLib.h"
 
 
-#define OUTPUT_GATE_T    "OUTPUT"
-#define INPUT_GATE_T     "INPUT"
-#define FLIP_FLOP_GATE_T "DFF"
-#define BUFFER_GATE_T    "BUFF"
-#define NOT_GATE_T       "NOT"
-#define AND_GATE_T       "AND"
-#define OR_GATE_T        "OR"
-#define NAND_GATE_T      "NAND"
-#define NOR_GATE_T       "NOR"
-#define XOR_GATE_T       "XOR"
-
 /* Type definitions */
 typedef std::string label_t;                        ///< Type definition for labels
+typedef bench_format::label_id_t label_id_t;        ///< Type definition for interned labels
+typedef size_t label_key_t;                         ///< Type definition for keys of the label tables, see LabelKey()
+typedef bench_format::gate_type_t gate_type_t;      ///< Type definition for the type of a gate
 typedef bench_format::bench_node_type bench_node_t; ///< Type definition for a node of the ISCAS85/89/99 bench format
 typedef size_t unique_ID_t;             ///< Type definition for unique identifiers for circuits
 typedef std::set<size_t> set_of_circuit_t;     ///< Type definition for set of circuits
 
+/**
+ * \class span_t
+ * \brief Read-only view of contiguous elements, like std::span of C++20.
+ *
+ */
+template<typename T>
+class span_t {
+public:
+    span_t() = default;
+
+    span_t(const T *first, size_t count) : first(first), count(count) {}
+
+    const T *begin() const { return first; }
+
+    const T *end() const { return first + count; }
+
+    size_t size() const { return count; }
+
+    bool empty() const { return count == 0; }
+
+    const T &operator[](size_t index) const { return first[index]; }
+
+    const T &front() const { return first[0]; }
+
+    /**
+     * \brief return the view without its first offset elements.
+     * \param offset is size_t, at most size()
+     * \return span_t
+     *
+     */
+    span_t subspan(size_t offset) const { return span_t(first + offset, count - offset); }
+
+private:
+    const T *first = nullptr;
+    size_t count = 0;
+};
+
 /**
  * \struct circuit_node_type
  * \brief Struct that represents a node from a circuit. 
  *
+ *  The lists of inputs and outputs are views of the adjacency arrays of the
+ *  BenchParser, and the label is a view of its label pool.
  */
 typedef struct circuit_node_t {
-    size_t id;                  ///< Unique ID for a node
-    std::string label;               ///< Node Label
-    std::string gate_type;           ///< Type of the gate (ex. AND, NOT, OR)
-    std::set<size_t> input_id_list;  ///< set containing all the inputs of the respective gate
-    std::set<size_t> output_id_list; ///< set containing all the outputs of the respective gate
+    unique_ID_t id;                     ///< Unique ID for a node, which is also its index in the sorted circuit
+    std::string_view label;             ///< Node Label
+    gate_type_t gate_type;              ///< Type of the gate (ex. AND, NOT, OR)
+    size_t level;                       ///< Topological level, one above the highest input. Nodes without inputs are at level 0
+    span_t<unique_ID_t> input_id_list;  ///< all inputs of the respective gate, without duplicates
+    span_t<unique_ID_t> output_id_list; ///< all outputs of the respective gate, in ascending order
 } circuit_node_t;
 
-typedef std::list<circuit_node_t> list_of_circuit_t; ///< Type definition for list of circuits
+typedef span_t<circuit_node_t> sorted_circuit_t; ///< Type definition for the topologically sorted circuit
+
+/**
+ * \struct circuit_cache_key_t
+ * \brief Identifies the version of a bench file that a circuit cache was built from.
+ *
+ */
+typedef struct circuit_cache_key_t {
+    std::string source_path;    ///< Canonical path of the bench file
+    uint64_t file_size;     ///< Size of the bench file in bytes
+    int64_t file_time;      ///< Last modification time of the bench file
+} circuit_cache_key_t;
 
 
 /**
@@ -65,22 +112,32 @@ private:
 
     size_t id_counter;
 
-    std::set<label_t> output_labels;     ///< Set containing bench node labels of all OUTPUT gates
-    std::set<label_t> ff_labels;   ///< Set containing bench node labels of all FLIP FLOP gates.
+    bench_format::LabelPool labels; ///< Every label of the bench file, stored once and referenced by the circuit nodes
+
+    std::vector<label_id_t> output_labels;     ///< Bench node labels of all OUTPUT gates
+    std::vector<label_id_t> ff_labels;   ///< Bench node labels of all FLIP FLOP gates.
     ///<  When a FLIP FLOP gate is parsed, it is split into two circuit's gates:
     ///< one will be handled as INPUT gate and the other one as OUTPUT gate.
 
     std::set<label_t> outputs;
 
+    std::vector<label_t> input_labels; ///< Labels of the primary INPUT gates in file order
+    std::vector<std::pair<label_t, label_t>> flip_flops; ///< Label of each FLIP FLOP and of its data input, in file order
+
     std::set<size_t> output_circuits;        ///< Set containing the unique ID of all OUTPUT gates
     std::set<size_t> input_circuits;        ///< Set containing the unique ID of all INPUT gates
 
-    std::unordered_map<label_t, bench_node_t> label_to_node;                   ///< Mapping from bench node labels to bench node
-    std::unordered_map<label_t, size_t> labels_to_id;                   ///< Mapping from bench node labels to circuit unique IDs
-    std::unordered_map<size_t, circuit_node_t> id_to_circuit_node;  ///< Mapping from circuit unique IDs to circuit nodes
+    std::unordered_map<label_key_t, bench_node_t> label_to_node;                   ///< Mapping from bench node labels to bench node
+    std::unordered_map<label_key_t, size_t> labels_to_id;                   ///< Mapping from bench node labels to circuit unique IDs
 
-    /* Topological Sorted Circuit */
-    list_of_circuit_t sorted_circuit; ///< List contained the topological sorted circuit nodes
+    /* Circuit graph. The IDs are dense and, once the circuit is sorted, follow the topological order */
+    std::vector<circuit_node_t> circuit_nodes;  ///< Circuit nodes indexed by their unique ID
+    std::vector<std::pair<unique_ID_t, unique_ID_t>> circuit_edges; ///< (node, input) pair of every edge
+    std::vector<size_t> input_offsets;   ///< The inputs of node i are input_ids[input_offsets[i]] to input_ids[input_offsets[i + 1] - 1]
+    std::vector<unique_ID_t> input_ids;
+    std::vector<size_t> output_offsets;  ///< The outputs of node i, stored like the inputs
+    std::vector<unique_ID_t> output_ids;
+    std::vector<size_t> level_offsets;   ///< The sorted nodes of level l have the unique IDs level_offsets[l] to level_offsets[l + 1] - 1
 
 
 
@@ -141,6 +198,34 @@ private:
      */
     void PrintCircuitByLabel(const label_t& node_label);
 
+    /**
+     * \brief return the key of a node in the label tables.
+     * \param label is label_id_t
+     * \param gate_type is the gate type of the node
+     * \return label_key_t
+     *
+     *  OUTPUT gates and FLIP FLOPS share their label with another node, so
+     *      their gate type is part of the key. All other gate types give the
+     *      key of the plain label.
+     */
+    static label_key_t LabelKey(label_id_t label, gate_type_t gate_type = gate_type_t::Input);
+
+    /**
+     * \brief return the printable name of a key of the label tables.
+     * \param key is label_key_t
+     * \return label_t, the label followed by OUTPUT or DFF if the key has a gate type
+     *
+     */
+    label_t KeyToLabel(label_key_t key);
+
+    /**
+     * \brief sorts labels alphabetically.
+     * \param label_ids is std::vector<label_id_t>
+     * \return none
+     *
+     */
+    void SortByLabel(std::vector<label_id_t>& label_ids);
+
     /**
      * \brief prints all circuits from the set of circuit OUTPUTS.
      * \param none
@@ -184,15 +269,7 @@ private:
      * \return circuit_node_type
      *
      */
-    circuit_node_t GetCircuitNode(unique_ID_t circuit_node_uuid);
-
-    /**
-     * \brief return the table representing the circuit.
-     * \param none
-     * \return unordered_map<unique_ID_t, circuit_node_type>
-     *
-     */
-    std::unordered_map<unique_ID_t, circuit_node_t> GetCircuit();
+    const circuit_node_t &GetCircuitNode(unique_ID_t circuit_node_uuid);
     /* ---------------
      * Read File Functions
      * ---------------
@@ -202,10 +279,23 @@ private:
      * \param bench_file is std::string.
      * \return bool returns true in case of success.
      *
-     *  Reads the file containing the circuit in the bench format.
+     *  Reads the file containing the circuit in the bench format. The file
+     *      is memory-mapped and tokenized in place, only labels are copied,
+     *      once each, into the label pool. Files ending in .aag or .aig are
+     *      read as AIGER, see parseAigerFile().
      */
     bool parseFile(const std::string& bench_file);
 
+    /**
+     * \brief Reads the file containing the circuit in the ASCII or binary AIGER format.
+     * \param aiger_file is std::string.
+     * \return bool returns true in case of success.
+     *
+     *  The And-Inverter Graph is translated into bench nodes by the
+     *      bench_format::AigerReader, so latches become FLIP FLOPS.
+     */
+    bool parseAigerFile(const std::string& aiger_file);
+
     /* ----------------
      * Insert functions
      * ----------------
@@ -238,7 +328,7 @@ private:
 
     /**
      * \brief find or add a node to the circuit given its label.
-     * \param node_label is label_t
+     * \param node_key is label_key_t
      * \return unique_ID_t representing the given label
      *
      *  It searches if the node corresponding to the given label is
@@ -247,7 +337,7 @@ private:
      *      and add it to the table.
      *
      */
-    unique_ID_t findOrAddToCircuitByLabel(const label_t& node_label);
+    unique_ID_t findOrAddToCircuitByLabel(label_key_t node_key);
 
     /* --------------------
      * Conversion functions
@@ -257,11 +347,32 @@ private:
     /**
      * \brief converts bench node to circuit node.
      * \param bench_node is bench_node_t and represents the node to be converted.
-     * \return circuit_node_type
+     * \return unique_ID_t of the new circuit node
+     *
+     *  Given a bench_node_t, it adds an equivalent node to the circuit and
+     *      records its input edges.
+     */
+    unique_ID_t benchNodeToCircuitNode(const bench_node_t& bench_node);
+
+    /**
+     * \brief builds the input and output arrays from the edges of the circuit.
+     * \param none
+     * \return none
+     *
+     *  Each node lists its inputs in the order of circuit_edges and its
+     *      outputs in ascending order.
+     */
+    void BuildAdjacency();
+
+    /**
+     * \brief renumbers the circuit nodes.
+     * \param order is the list of all unique IDs in their new order
+     * \return none
      *
-     *  Given a bench_node_t, it converts the node into an circuit_node_type.
+     *  The node order[i] gets the unique ID i. The inputs of every node
+     *      keep their order.
      */
-    circuit_node_t benchNodeToCircuitNode(const bench_node_t& bench_node);
+    void RenumberCircuit(const std::vector<unique_ID_t>& order);
 
     /*
      *
@@ -279,11 +390,11 @@ private:
 
     /**
      * \brief create a circuit from the given node's label.
-     * \param bnode_label is label_t
+     * \param bnode_key is label_key_t
      * \return none
      *
      */
-    void createCircuitByLabel(const label_t& bnode_label);
+    void createCircuitByLabel(label_key_t bnode_key);
 
     /* -----------------------------
      * Topological Sort Algorithms
@@ -293,49 +404,109 @@ private:
     /**
      * \brief Implementation of Kahn's Algorithm for topological sort.
      * \param none
-     * \return none (the result is stored at sorted_circuit variable)
+     * \return none (the circuit nodes are renumbered in topological order)
      *
+     *  Runs in O(V + E) with a counter of unsorted inputs per node. The
+     *      nodes are sorted level by level, starting with the INPUT gates
+     *      in the order of the INPUT lines.
      */
     void TopologicalSortKahnsAlgorithm();
 
     /* -----------------------------
-     * Auxiliar functions for
-     * Topological Sort Algorithms
+     * Circuit Cache
      * -----------------------------
      */
 
     /**
-     * \brief auxiliar function for topological sort algorithms.
-     * \param src_node is unique_ID_t
-     * \param dst_node is unique_ID_t
-     * \return True if it was the only outgoing edge. False, otherwise.
+     * \brief return the path of the circuit cache of a bench file.
+     * \param bench_file is std::string
+     * \return std::string, "results_<name>/<name>.circuit" like the other results of the file
+     *
+     */
+    static std::string GetCacheFileName(const std::string& bench_file);
+
+    /**
+     * \brief return the canonical path, size and modification time of a bench file.
+     * \param bench_file is std::string
+     * \param key is circuit_cache_key_t to fill
+     * \return bool, false if the file system metadata cannot be read
+     *
+     *  Only the file system metadata is read, so a warm start never reads
+     *      the bench file itself. The cache file name only holds the stem, so
+     *      the path tells apart files that share it.
+     */
+    static bool GetCacheKey(const std::string& bench_file, circuit_cache_key_t &key);
+
+    /**
+     * \brief loads the sorted circuit from a cache file.
+     * \param cache_file is std::string
+     * \param key is circuit_cache_key_t of the bench file
+     * \return bool returns true in case of success.
      *
-     * It removes the edge from src->dst at the table uuid2circuitNode and
-     * then checks if it was the only outgoing edge.
+     *  The cache is rejected if it does not exist, has another format
+     *      version or was built from another version of the bench file.
      */
-    bool IsUniqueOutgoingEdge(unique_ID_t src_node, unique_ID_t dst_node);
+    bool loadCircuitCache(const std::string& cache_file, const circuit_cache_key_t& key);
+
+    /**
+     * \brief writes the sorted circuit to a cache file.
+     * \param cache_file is std::string
+     * \param key is circuit_cache_key_t of the bench file
+     * \return bool returns true in case of success.
+     *
+     *  The file is written under a temporary name and then renamed, so an
+     *      interrupted run never leaves a truncated cache behind.
+     */
+    bool writeCircuitCache(const std::string& cache_file, const circuit_cache_key_t& key);
 
 public:
     /**
     * \brief Constructor
     * \param bench_file the path to the benchmark file
+    * \param use_cache whether to load and store the sorted circuit in a cache file
     *
     * Constructor method for the bench_circuit_manager class. It
     * generates the topological circuit described in the file
     * bench_file that must be in the ISCAS85/ISCAS89/ISCAS99 format.
+    * The sorted circuit is stored in a binary cache file next to the
+    * results, so later runs on the same file skip parsing and sorting.
     */
-    explicit BenchParser(const std::string& bench_file);
+    explicit BenchParser(const std::string& bench_file, bool use_cache = true);
 
     ~BenchParser();
 
+    /* The circuit nodes point into the arrays of the parser, so it cannot be copied */
+    BenchParser(const BenchParser&) = delete;
+
+    BenchParser& operator=(const BenchParser&) = delete;
+
 
     /**
      * \brief return the list of circuit nodes topologically sorted.
      * \param none
-     * \return list_of_circuit_t
+     * \return sorted_circuit_t, valid as long as the parser exists
+     *
+     *  The node at index i has the unique ID i.
+     */
+    sorted_circuit_t GetSortedCircuit();
+
+    /**
+     * \brief return the number of topological levels of the circuit.
+     * \param none
+     * \return size_t
+     *
+     */
+    size_t GetNumberOfLevels();
+
+    /**
+     * \brief return the circuit nodes of one topological level.
+     * \param level is size_t, less than GetNumberOfLevels()
+     * \return sorted_circuit_t, a contiguous part of GetSortedCircuit()
      *
+     *  All inputs of the nodes of a level are on lower levels, so the
+     *      nodes of one level do not depend on each other.
      */
-    list_of_circuit_t GetSortedCircuit();
+    sorted_circuit_t GetLevel(size_t level);
 
     /**
      * \brief return a list with the labels of the OUTPUT gates of the circuit. The label's list also includes the FLIP_FLOPS
@@ -345,4 +516,21 @@ public:
      */
     std::set<label_t> GetListOfOutputLabels();
 
+    /**
+     * \brief return the labels of the primary INPUT gates, excluding the FLIP FLOPS.
+     * \param none
+     * \return std::vector<label_t> in the order of the bench file
+     *
+     */
+    std::vector<label_t> GetListOfInputLabels();
+
+    /**
+     * \brief return the FLIP FLOPS of the circuit.
+     * \param none
+     * \return std::vector<std::pair<label_t, label_t>> holding the label of each FLIP FLOP,
+     *         which is its output, and the label of its data input, in the order of the bench file
+     *
+     */
+    std::vector<std::pair<label_t, label_t>> GetListOfFlipFlops();
+
 };
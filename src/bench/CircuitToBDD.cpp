@@ -5,18 +5,160 @@
 
 #include "CircuitToBDD.hpp"
 
+#include "../Manager.h"
+
+#include <algorithm>
+#include <queue>
 #include <utility>
 
 
 CircuitToBDD::CircuitToBDD(shared_ptr<ClassProject::ManagerInterface> BDD_manager_p) {
     bdd_manager = std::move(BDD_manager_p);
+    manager = std::dynamic_pointer_cast<ClassProject::Manager>(bdd_manager);
 }
 
 CircuitToBDD::~CircuitToBDD() = default;
 
-void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::string& benchmark_file) {
-    ClassProject::BDD_ID BDD_node;
+void CircuitToBDD::GenerateBDD(const sorted_circuit_t &circuit, const std::string& benchmark_file) {
+    GenerateBDD(circuit, benchmark_file, std::vector<bool>(circuit.size(), true));
+}
+
+void CircuitToBDD::GenerateBDD(const sorted_circuit_t &circuit, const std::string& benchmark_file,
+                               const std::set<label_t> &output_labels) {
+    GenerateBDD(circuit, benchmark_file, FanInCone(circuit, output_labels));
+}
+
+std::vector<bool> CircuitToBDD::FanInCone(const sorted_circuit_t &circuit, const std::set<label_t> &output_labels) {
+    std::vector<bool> in_cone(circuit.size(), false);
+    std::set<label_t> missing_labels = output_labels;
+
+    /* OUTPUT and FLIP FLOP nodes share the label of another node, which computes the function */
+    for (const auto &circuit_node : circuit) {
+        if ((circuit_node.gate_type != gate_type_t::Output) && (circuit_node.gate_type != gate_type_t::FlipFlop) &&
+            (output_labels.count(label_t(circuit_node.label)) != 0)) {
+            in_cone[circuit_node.id] = true;
+            missing_labels.erase(label_t(circuit_node.label));
+        }
+    }
+    if (!missing_labels.empty()) {
+        throw std::runtime_error("There is no gate with the label " + *missing_labels.begin() + "!");
+    }
+
+    /* Inputs have smaller unique IDs, so one backward pass collects the whole cone */
+    for (size_t id = circuit.size(); id-- > 0;) {
+        if (in_cone[id]) {
+            for (unique_ID_t input : circuit[id].input_id_list) {
+                in_cone[input] = true;
+            }
+        }
+    }
+    return in_cone;
+}
+
+void CircuitToBDD::GenerateBDD(const sorted_circuit_t &circuit, const std::string& benchmark_file,
+                               const std::vector<bool> &in_cone) {
+    std::ofstream bdd_out_file = OpenResultFiles(benchmark_file);
+
+    CreateOrderedVariables(circuit, in_cone);
+
+    for (const auto &circuit_node : circuit) {
+        /* OUTPUT or FLIP FLOP gates do not generate a BDD */
+        if (!in_cone[circuit_node.id] || !HasBDD(circuit_node.gate_type)) {
+            continue;
+        }
+        AddBDD(circuit_node, GateBDD(circuit_node), bdd_out_file);
+    }
+
+    bdd_out_file.close();
+}
+
+void CircuitToBDD::StreamBDD(const sorted_circuit_t &circuit, const std::string &benchmark_file,
+                             const std::set<label_t> &output_labels) {
+    const std::vector<bool> in_cone = FanInCone(circuit, output_labels);
+    std::ofstream bdd_out_file = OpenResultFiles(benchmark_file);
+    CreateOutputDirectories();
+
+    /* Garbage collection needs the concrete manager, other managers only release the references */
+    size_t collected_size = manager ? manager->liveNodeCount() : 0;
+
+    /* Every gate in the cone holds a reference to its inputs, every selected output one to itself */
+    std::vector<size_t> references(circuit.size(), 0);
+    std::vector<unique_ID_t> outputs;
+    for (const auto &circuit_node : circuit) {
+        if (!in_cone[circuit_node.id] || !HasBDD(circuit_node.gate_type)) {
+            continue;
+        }
+        for (unique_ID_t input : circuit_node.input_id_list) {
+            references[input]++;
+        }
+        if (output_labels.count(label_t(circuit_node.label)) != 0) {
+            references[circuit_node.id]++;
+            outputs.push_back(circuit_node.id);
+        }
+    }
+
+    auto release = [&](unique_ID_t id) {
+        if (--references[id] == 0) {
+            node_to_bdd_id.erase(id);
+            label_to_bdd_id.erase(label_t(circuit[id].label));
+        }
+    };
+
+    /* All variables are created first, so the variable order is the same as in GenerateBDD */
+    CreateOrderedVariables(circuit, in_cone);
+    std::vector<bool> built(circuit.size(), false);
+    for (const auto &circuit_node : circuit) {
+        if (in_cone[circuit_node.id] && (circuit_node.gate_type == gate_type_t::Input)) {
+            AddBDD(circuit_node, GateBDD(circuit_node), bdd_out_file);
+            built[circuit_node.id] = true;
+        }
+    }
+
+    /* Each output is built depth first from the gates that are still missing in its cone */
+    std::vector<std::pair<unique_ID_t, size_t>> stack;
+    for (unique_ID_t output : outputs) {
+        if (!built[output]) {
+            stack.emplace_back(output, 0);
+            built[output] = true;
+        }
+        while (!stack.empty()) {
+            const unique_ID_t id = stack.back().first;
+            const auto &inputs = circuit[id].input_id_list;
+            if (stack.back().second < inputs.size()) {
+                const unique_ID_t input = inputs[stack.back().second++];
+                if (!built[input]) {
+                    stack.emplace_back(input, 0);
+                    built[input] = true;
+                }
+                continue;
+            }
+            stack.pop_back();
+
+            AddBDD(circuit[id], GateBDD(circuit[id]), bdd_out_file);
+            for (unique_ID_t input : inputs) {
+                release(input);
+            }
+        }
+
+        WriteBDD(label_t(circuit[output].label), findBddId(output));
+        release(output);
+
+        /* Collect the released nodes whenever the table has doubled since the last collection */
+        if (manager && (manager->liveNodeCount() > std::max(2 * collected_size, STREAM_MIN_COLLECTION))) {
+            std::vector<ClassProject::BDD_ID> roots;
+            roots.reserve(node_to_bdd_id.size());
+            for (const auto &node_bdd : node_to_bdd_id) {
+                roots.push_back(node_bdd.second);
+            }
+            manager->collectGarbage(roots);
+            collected_size = manager->liveNodeCount();
+        }
+    }
 
+    bdd_out_file.close();
+}
+
+std::ofstream CircuitToBDD::OpenResultFiles(const std::string &benchmark_file) {
     std::filesystem::path pathToBenchFile(benchmark_file);
     if (!pathToBenchFile.has_filename())
         throw std::runtime_error("circuit_to_BDD_manager::GenerateBDD: benchmark_file not specified");
@@ -35,35 +177,62 @@ void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit, const std::stri
     }
 
     bdd_out_file << "BDD_ID,Bench Label" << std::endl;
+    return bdd_out_file;
+}
 
-    for (const auto &circuit_node : circuit) {
-        if (circuit_node.gate_type == INPUT_GATE_T) {
-            BDD_node = InputGate(circuit_node.label);
-        } else if (circuit_node.gate_type == NOT_GATE_T) {
-            BDD_node = NotGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == AND_GATE_T) {
-            BDD_node = AndGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == OR_GATE_T) {
-            BDD_node = OrGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == NAND_GATE_T) {
-            BDD_node = NandGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == NOR_GATE_T) {
-            BDD_node = NorGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == XOR_GATE_T) {
-            BDD_node = XorGate(circuit_node.input_id_list);
-        } else if (circuit_node.gate_type == BUFFER_GATE_T) {
-            BDD_node = findBddId(*circuit_node.input_id_list.begin());
+void CircuitToBDD::CreateOrderedVariables(const sorted_circuit_t &circuit, const std::vector<bool> &in_cone) {
+    /* The variables of the given order are created before any gate */
+    if (!variable_order.empty()) {
+        std::set<label_t> cone_inputs;
+        for (const auto &circuit_node : circuit) {
+            if ((circuit_node.gate_type == gate_type_t::Input) && in_cone[circuit_node.id]) {
+                cone_inputs.emplace(circuit_node.label);
+            }
         }
-
-        /* OUTPUT or FLIP FLOP gates do not generate a BDD */
-        if (!((circuit_node.gate_type == OUTPUT_GATE_T) | (circuit_node.gate_type == FLIP_FLOP_GATE_T))) {
-            node_to_bdd_id.insert(std::pair<unique_ID_t, ClassProject::BDD_ID>(circuit_node.id, BDD_node));
-            label_to_bdd_id.insert(std::pair<label_t, ClassProject::BDD_ID>(circuit_node.label, BDD_node));
-            bdd_out_file << BDD_node << "," << circuit_node.label << std::endl;
+        for (const auto &label : variable_order) {
+            if ((cone_inputs.count(label) != 0) && (input_variables.count(label) == 0)) {
+                input_variables[label] = bdd_manager->createVar(label);
+            }
         }
     }
+}
 
-    bdd_out_file.close();
+bool CircuitToBDD::HasBDD(gate_type_t gate_type) {
+    return (gate_type != gate_type_t::Output) && (gate_type != gate_type_t::FlipFlop);
+}
+
+ClassProject::BDD_ID CircuitToBDD::GateBDD(const circuit_node_t &circuit_node) {
+    switch (circuit_node.gate_type) {
+        case gate_type_t::Input:
+            return InputGate(label_t(circuit_node.label));
+        case gate_type_t::Not:
+            return NotGate(circuit_node.input_id_list);
+        case gate_type_t::And:
+            return AndGate(circuit_node.input_id_list);
+        case gate_type_t::Or:
+            return OrGate(circuit_node.input_id_list);
+        case gate_type_t::Nand:
+            return NandGate(circuit_node.input_id_list);
+        case gate_type_t::Nor:
+            return NorGate(circuit_node.input_id_list);
+        case gate_type_t::Xor:
+            return XorGate(circuit_node.input_id_list);
+        case gate_type_t::Buffer:
+            return findBddId(circuit_node.input_id_list.front());
+        case gate_type_t::Zero:
+            return bdd_manager->False();
+        case gate_type_t::Output:
+        case gate_type_t::FlipFlop:
+            break;
+    }
+    throw std::runtime_error("OUTPUT and FLIP FLOP gates do not generate a BDD!");
+}
+
+void CircuitToBDD::AddBDD(const circuit_node_t &circuit_node, ClassProject::BDD_ID BDD_node,
+                          std::ofstream &bdd_out_file) {
+    node_to_bdd_id.insert(std::pair<unique_ID_t, ClassProject::BDD_ID>(circuit_node.id, BDD_node));
+    label_to_bdd_id.insert(std::pair<label_t, ClassProject::BDD_ID>(circuit_node.label, BDD_node));
+    bdd_out_file << BDD_node << "," << circuit_node.label << std::endl;
 }
 
 
@@ -79,172 +248,177 @@ ClassProject::BDD_ID CircuitToBDD::findBddId(unique_ID_t circuit_node) {
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::InputGate(const label_t &label) {
-    return bdd_manager->createVar(label);
+void CircuitToBDD::SetInputVariables(const std::unordered_map<label_t, ClassProject::BDD_ID> &variables) {
+    input_variables = variables;
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::NotGate(const set_of_circuit_t &inputNodes) {
-    unique_ID_t node = *inputNodes.begin();
-    return bdd_manager->neg(findBddId(node));
+void CircuitToBDD::SetVariableOrder(const std::vector<label_t> &labels) {
+    variable_order = labels;
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::AndGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
+ClassProject::BDD_ID CircuitToBDD::GetBddId(const label_t &label) {
 
-    /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
+    auto bdd_id_it = label_to_bdd_id.find(label);
 
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
-
-        first_op = bdd_manager->and2(first_op, second_op);
+    if (bdd_id_it != label_to_bdd_id.end()) {
+        return bdd_id_it->second;
+    } else {
+        throw std::runtime_error("There is no BDD for the label " + label + "!");
     }
-
-    /* Return the ClassProject::BDD_ID equivalent to the AND of all inputs */
-    return first_op;
 }
 
 
-ClassProject::BDD_ID CircuitToBDD::OrGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
-
-    /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
+ClassProject::BDD_ID CircuitToBDD::InputGate(const label_t &label) {
 
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
+    auto variable_it = input_variables.find(label);
 
-        first_op = bdd_manager->or2(first_op, second_op);
+    if (variable_it != input_variables.end()) {
+        return variable_it->second;
     }
 
-    /* Return the ClassProject::BDD_ID equivalent to the OR of all inputs */
-    return first_op;
+    return bdd_manager->createVar(label);
 }
 
-ClassProject::BDD_ID CircuitToBDD::NandGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
 
-    /* Get the ClassProject::BDD_ID of first elements */
-    it = inputNodes.begin();
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
+ClassProject::BDD_ID CircuitToBDD::NotGate(span_t<unique_ID_t> inputNodes) {
+    unique_ID_t node = inputNodes.front();
+    return bdd_manager->neg(findBddId(node));
+}
 
-    if (inputNodes.size() == 1) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
 
-        /* Create the NAND BDD node for the first two elements */
-        first_op = bdd_manager->nand2(first_op, second_op);
-    } else {
-        /* AND of all inputs, to use as the second operator of the NAND gate */
-        second_op = AndGate(inputNodes);
-        /* Create the NAND BDD node */
-        first_op = bdd_manager->nand2(first_op, second_op);
-    }
+ClassProject::BDD_ID CircuitToBDD::AndGate(span_t<unique_ID_t> inputNodes) {
+    auto operands = ReduceInputs(inputNodes, &ClassProject::ManagerInterface::and2, bdd_manager->True());
 
-    /* Return the ClassProject::BDD_ID equivalent to the NAND of all inputs */
-    return first_op;
+    /* Return the ClassProject::BDD_ID equivalent to the AND of all inputs */
+    return bdd_manager->and2(operands.first, operands.second);
 }
 
-ClassProject::BDD_ID CircuitToBDD::NorGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
 
-    /* Get the ClassProject::BDD_ID of first elements */
-    it = inputNodes.begin();
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
+ClassProject::BDD_ID CircuitToBDD::OrGate(span_t<unique_ID_t> inputNodes) {
+    auto operands = ReduceInputs(inputNodes, &ClassProject::ManagerInterface::or2, bdd_manager->False());
 
-    if (inputNodes.size() == 1) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
+    /* Return the ClassProject::BDD_ID equivalent to the OR of all inputs */
+    return bdd_manager->or2(operands.first, operands.second);
+}
 
-        /* Create the NOR BDD node for the first two elements */
-        first_op = bdd_manager->nor2(first_op, second_op);
-    } else {
-        /* OR of all inputs, to use as the second operator of the NAND gate */
-        second_op = OrGate(inputNodes);
-        /* Create the NOR BDD node */
-        first_op = bdd_manager->nor2(first_op, second_op);
-    }
+ClassProject::BDD_ID CircuitToBDD::NandGate(span_t<unique_ID_t> inputNodes) {
+    /* The inputs are reduced with AND, the last operation inverts the result */
+    auto operands = ReduceInputs(inputNodes, &ClassProject::ManagerInterface::and2, bdd_manager->True());
+
+    /* Return the ClassProject::BDD_ID equivalent to the NAND of all inputs */
+    return bdd_manager->nand2(operands.first, operands.second);
+}
+
+ClassProject::BDD_ID CircuitToBDD::NorGate(span_t<unique_ID_t> inputNodes) {
+    /* The inputs are reduced with OR, the last operation inverts the result */
+    auto operands = ReduceInputs(inputNodes, &ClassProject::ManagerInterface::or2, bdd_manager->False());
 
     /* Return the ClassProject::BDD_ID equivalent to the NOR of all inputs */
-    return first_op;
+    return bdd_manager->nor2(operands.first, operands.second);
+}
+
+ClassProject::BDD_ID CircuitToBDD::XorGate(span_t<unique_ID_t> inputNodes) {
+    auto operands = ReduceInputs(inputNodes, &ClassProject::ManagerInterface::xor2, bdd_manager->False());
+
+    /* Return the ClassProject::BDD_ID equivalent to the XOR of all inputs */
+    return bdd_manager->xor2(operands.first, operands.second);
 }
 
-ClassProject::BDD_ID CircuitToBDD::XorGate(set_of_circuit_t inputNodes) {
-    auto it = inputNodes.begin();
-    ClassProject::BDD_ID first_op, second_op;
+std::pair<ClassProject::BDD_ID, ClassProject::BDD_ID>
+CircuitToBDD::ReduceInputs(span_t<unique_ID_t> inputNodes,
+                           ClassProject::BDD_ID (ClassProject::ManagerInterface::*combine)(ClassProject::BDD_ID,
+                                                                                           ClassProject::BDD_ID),
+                           ClassProject::BDD_ID neutral) {
+    if (inputNodes.size() == 1) {
+        return {findBddId(inputNodes.front()), neutral};
+    }
+    if (inputNodes.size() == 2) {
+        /* Nothing to choose, so the sizes are not needed */
+        return {findBddId(inputNodes[0]), findBddId(inputNodes[1])};
+    }
 
-    /* Get the ClassProject::BDD_ID of first elements */
-    first_op = findBddId(*it);
-    inputNodes.erase(it);
+    /* Min-heap of (size, BDD_ID), ties are broken by the BDD_ID to stay deterministic.
+       The size of every operand is counted once, when it is pushed. */
+    typedef std::pair<size_t, ClassProject::BDD_ID> sized_operand_t;
+    std::priority_queue<sized_operand_t, std::vector<sized_operand_t>, std::greater<>> operands;
+    for (unique_ID_t input : inputNodes) {
+        ClassProject::BDD_ID operand = findBddId(input);
+        operands.emplace(BddSize(operand), operand);
+    }
 
-    while (!inputNodes.empty()) {
-        it = inputNodes.begin();
-        second_op = findBddId(*it);
-        inputNodes.erase(it);
+    while (operands.size() > 2) {
+        ClassProject::BDD_ID first_op = operands.top().second;
+        operands.pop();
+        ClassProject::BDD_ID second_op = operands.top().second;
+        operands.pop();
 
-        first_op = bdd_manager->xor2(first_op, second_op);
+        ClassProject::BDD_ID result = ((*bdd_manager).*combine)(first_op, second_op);
+        operands.emplace(BddSize(result), result);
     }
 
-    /* Return the ClassProject::BDD_ID equivalent to the XOR of all inputs */
-    return first_op;
+    ClassProject::BDD_ID first_op = operands.top().second;
+    operands.pop();
+    return {first_op, operands.top().second};
 }
 
+size_t CircuitToBDD::BddSize(ClassProject::BDD_ID root) {
+    if (manager) {
+        return manager->nodeCount(root);
+    }
+    std::set<ClassProject::BDD_ID> nodes;
+    bdd_manager->findNodes(root, nodes);
+    return nodes.size();
+}
+
+
 void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
 
-    if ((!(std::filesystem::exists(result_dir + "/txt")) &
-         !(std::filesystem::create_directory(result_dir + "/txt")))
-        & (!(std::filesystem::exists(result_dir + "/dot")) &
-           !(std::filesystem::create_directory(result_dir + "/dot")))) {
-        throw std::runtime_error("Unable to create directories 'txt' and 'dot' for the output!");
-    }
+    CreateOutputDirectories();
 
     for (const auto &output_label : output_labels) {
 
         auto output_id_it = label_to_bdd_id.find(output_label);
 
         if (output_id_it != label_to_bdd_id.end()) {
+            WriteBDD(output_label, output_id_it->second);
+        } else {
+            throw std::runtime_error("Destination node UUID is not part of the circuit graph!");
+        }
+    }
+}
 
-            std::string dot_file_name = result_dir + "/dot/" + std::string(output_label) + ".dot";
-            std::string txt_file_name = result_dir + "/txt/" + std::string(output_label) + ".txt";
+void CircuitToBDD::CreateOutputDirectories() {
+    if ((!(std::filesystem::exists(result_dir + "/txt")) &
+         !(std::filesystem::create_directory(result_dir + "/txt")))
+        & (!(std::filesystem::exists(result_dir + "/dot")) &
+           !(std::filesystem::create_directory(result_dir + "/dot")))) {
+        throw std::runtime_error("Unable to create directories 'txt' and 'dot' for the output!");
+    }
+}
 
-            std::ofstream bdd_out_dot_file(dot_file_name);
-            std::ofstream bdd_out_txt_file(txt_file_name);
+void CircuitToBDD::WriteBDD(const label_t &output_label, ClassProject::BDD_ID root) {
+    std::string dot_file_name = result_dir + "/dot/" + std::string(output_label) + ".dot";
+    std::string txt_file_name = result_dir + "/txt/" + std::string(output_label) + ".txt";
 
-            if (!bdd_out_dot_file.is_open() | !bdd_out_txt_file.is_open()) {
-                throw std::runtime_error("Unable to open Log File!");
-            }
+    std::ofstream bdd_out_dot_file(dot_file_name);
+    std::ofstream bdd_out_txt_file(txt_file_name);
 
-            output_nodes.clear();
-            output_vars.clear();
-            bdd_manager->findNodes(output_id_it->second, output_nodes);
-            bdd_manager->findVars(output_id_it->second, output_vars);
+    if (!bdd_out_dot_file.is_open() | !bdd_out_txt_file.is_open()) {
+        throw std::runtime_error("Unable to open Log File!");
+    }
 
-            dumpBddText(bdd_out_txt_file);
-            dumpBddDot(bdd_out_dot_file);
+    output_nodes.clear();
+    output_vars.clear();
+    bdd_manager->findNodes(root, output_nodes);
+    bdd_manager->findVars(root, output_vars);
 
-            bdd_out_dot_file.close();
-            bdd_out_txt_file.close();
+    dumpBddText(bdd_out_txt_file);
+    dumpBddDot(bdd_out_dot_file);
 
-        } else {
-            throw std::runtime_error("Destination node UUID is not part of the circuit graph!");
-        }
-    }
+    bdd_out_dot_file.close();
+    bdd_out_txt_file.close();
 }
 
 void CircuitToBDD::dumpBddText(std::ostream &out) {
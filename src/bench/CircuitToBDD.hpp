@@ -7,6 +7,7 @@
 
 #include "BenchParser.hpp"
 #include "../ManagerInterface.h"
+#include "../Manager.h"
 #include <iostream>
 #include <fstream>
 #include <filesystem>
@@ -37,7 +38,46 @@ public:
      *  Generates the calls to the BDD package in order to
      *   generate the BDD equivalent to the provided circuit.
      */
-    void GenerateBDD(const std::list<circuit_node_t> &circuit, const std::string& benchmark_file);
+    void GenerateBDD(const sorted_circuit_t &circuit, const std::string& benchmark_file);
+
+    /**
+     * \brief Generates the BDDs of the given outputs only
+     * \param Topologically sorted list containing the circuit nodes
+     * \param The labels of the gates to build, usually a subset of the OUTPUT labels
+     * \return none
+     *
+     *  Only the gates in the transitive fan-in cones of the given labels
+     *   are converted, so only the INPUT gates in these cones create
+     *   variables. Throws if a label names no gate of the circuit.
+     */
+    void GenerateBDD(const sorted_circuit_t &circuit, const std::string& benchmark_file,
+                     const std::set<label_t> &output_labels);
+
+    /**
+     * \brief Generates and prints the BDDs of the given outputs one after the other
+     * \param Topologically sorted list containing the circuit nodes
+     * \param The labels of the gates to build and print, usually the OUTPUT labels
+     * \return none
+     *
+     *  The outputs are built in circuit order, each one depth first from the
+     *   gates of its cone that are still missing, and printed like PrintBDD
+     *   as soon as they are complete. A gate is released once all gates
+     *   reading it are built. A ClassProject::Manager then frees the released
+     *   nodes whenever its table has doubled since the last collection, so the
+     *   manager must not hold other BDDs that are still needed. Afterwards
+     *   GetBddId finds none of the generated BDDs.
+     */
+    void StreamBDD(const sorted_circuit_t &circuit, const std::string &benchmark_file,
+                   const std::set<label_t> &output_labels);
+
+    /**
+     * \brief Returns the transitive fan-in cone of the given labels
+     * \param Topologically sorted list containing the circuit nodes
+     * \param The labels of the gates whose cones are collected
+     * \return std::vector<bool>, true at the unique ID of every node in a cone
+     *
+     */
+    static std::vector<bool> FanInCone(const sorted_circuit_t &circuit, const std::set<label_t> &output_labels);
 
 
     /**
@@ -47,18 +87,123 @@ public:
      */
     void PrintBDD(const std::set<label_t> &output_labels);
 
+    /**
+     * \brief Predefines the BDD variables of INPUT gates
+     * \param Mapping from the label of an INPUT gate to an existing variable
+     * \return none
+     *
+     *  INPUT gates found in the mapping reuse the given variable instead
+     *   of creating a new one. Must be called before GenerateBDD.
+     */
+    void SetInputVariables(const std::unordered_map<label_t, ClassProject::BDD_ID> &variables);
+
+    /**
+     * \brief Sets the order in which the variables of INPUT gates are created
+     * \param Labels of INPUT gates, the first label becomes the top variable
+     * \return none
+     *
+     *  GenerateBDD creates these variables before the first gate, skipping
+     *   predefined variables and INPUT gates outside the converted cone.
+     *   Remaining INPUT gates are created in circuit order. Must be called
+     *   before GenerateBDD.
+     */
+    void SetVariableOrder(const std::vector<label_t> &labels);
+
+    /**
+     * \brief Returns the BDD_ID generated for the node with the given label
+     * \param label is label_t
+     * \return ClassProject::BDD_ID
+     *
+     */
+    ClassProject::BDD_ID GetBddId(const label_t &label);
+
 private:
 
     std::unordered_map<unique_ID_t, ClassProject::BDD_ID> node_to_bdd_id; ///< Mapping from circuit node's unique ID to its BDD ID
     std::unordered_map<label_t, ClassProject::BDD_ID> label_to_bdd_id; ///< Mapping from node's label to its BDD ID
+    std::unordered_map<label_t, ClassProject::BDD_ID> input_variables; ///< Predefined variables of INPUT gates
+    std::vector<label_t> variable_order; ///< Creation order of the variables of INPUT gates
+
+    static constexpr size_t STREAM_MIN_COLLECTION = 1 << 16; ///< StreamBDD collects garbage only above this many nodes
 
     shared_ptr<ClassProject::ManagerInterface> bdd_manager{};
+    shared_ptr<ClassProject::Manager> manager{}; ///< bdd_manager if it is a ClassProject::Manager, for node counts and garbage collection
     std::string result_dir; ///< Directory where the results are stored
 
     std::set<ClassProject::BDD_ID> output_nodes;
     std::set<ClassProject::BDD_ID> output_vars;
 
 
+    /**
+     * \brief Generates the BDDs of the nodes marked in in_cone
+     * \param Topologically sorted list containing the circuit nodes
+     * \param in_cone is true at the unique ID of every node to convert
+     * \return none
+     *
+     */
+    void GenerateBDD(const sorted_circuit_t &circuit, const std::string& benchmark_file,
+                     const std::vector<bool> &in_cone);
+
+    /**
+     * \brief Creates the result directory and opens the log of all generated BDD_IDs
+     * \param benchmark_file names the result directory
+     * \return std::ofstream
+     *
+     */
+    std::ofstream OpenResultFiles(const std::string &benchmark_file);
+
+    /**
+     * \brief Creates the variables of the variable order that belong to INPUT gates of the cone
+     * \param Topologically sorted list containing the circuit nodes
+     * \param in_cone is true at the unique ID of every node to convert
+     * \return none
+     *
+     */
+    void CreateOrderedVariables(const sorted_circuit_t &circuit, const std::vector<bool> &in_cone);
+
+    /**
+     * \brief Returns false for OUTPUT and FLIP FLOP gates, which do not generate a BDD
+     * \param gate_type is gate_type_t
+     * \return bool
+     *
+     */
+    static bool HasBDD(gate_type_t gate_type);
+
+    /**
+     * \brief Generates the BDD of a gate whose inputs are converted already
+     * \param circuit_node is the gate
+     * \return ClassProject::BDD_ID
+     *
+     */
+    ClassProject::BDD_ID GateBDD(const circuit_node_t &circuit_node);
+
+    /**
+     * \brief Records the BDD of a gate and logs it
+     * \param circuit_node is the gate
+     * \param BDD_node is the BDD of the gate
+     * \param bdd_out_file is the log of all generated BDD_IDs
+     * \return none
+     *
+     */
+    void AddBDD(const circuit_node_t &circuit_node, ClassProject::BDD_ID BDD_node, std::ofstream &bdd_out_file);
+
+    /**
+     * \brief Creates the directories 'txt' and 'dot' in the result directory
+     * \param none
+     * \return none
+     *
+     */
+    void CreateOutputDirectories();
+
+    /**
+     * \brief Writes one BDD in text and dot format
+     * \param output_label names the files
+     * \param root is the BDD to write
+     * \return none
+     *
+     */
+    void WriteBDD(const label_t &output_label, ClassProject::BDD_ID root);
+
     /**
      * \brief Returns the BDD_ID of the given circuit ID
      * \param circuit_node is unique_ID_t
@@ -77,51 +222,72 @@ private:
 
     /**
      * \brief Generates the BDD node equivalent to the NOT gate.
-     * \param node is set_of_circuit_t containing the circuit ID of the gate to be inverted.
+     * \param node is span_t<unique_ID_t> containing the circuit ID of the gate to be inverted.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID NotGate(const set_of_circuit_t &node);
+    ClassProject::BDD_ID NotGate(span_t<unique_ID_t> inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the AND gate.
-     * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
+     * \param node is span_t<unique_ID_t> containing the circuit IDs of the gates to be used as input.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID AndGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID AndGate(span_t<unique_ID_t> inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the OR gate.
-     * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
+     * \param node is span_t<unique_ID_t> containing the circuit IDs of the gates to be used as input.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID OrGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID OrGate(span_t<unique_ID_t> inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the NAND gate.
-     * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
+     * \param node is span_t<unique_ID_t> containing the circuit IDs of the gates to be used as input.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID NandGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID NandGate(span_t<unique_ID_t> inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the NOR gate.
-     * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
+     * \param node is span_t<unique_ID_t> containing the circuit IDs of the gates to be used as input.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID NorGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID NorGate(span_t<unique_ID_t> inputNodes);
 
     /**
      * \brief Generates the BDD node equivalent to the XOR gate.
-     * \param node is set_of_circuit_t containing the circuit IDs of the gates to be used as input.
+     * \param node is span_t<unique_ID_t> containing the circuit IDs of the gates to be used as input.
      * \return ClassProject::BDD_ID
      *
      */
-    ClassProject::BDD_ID XorGate(set_of_circuit_t inputNodes);
+    ClassProject::BDD_ID XorGate(span_t<unique_ID_t> inputNodes);
+
+    /**
+     * \brief Reduces the inputs of a gate to two operands, always combining the two smallest BDDs first.
+     * \param inputNodes is span_t<unique_ID_t> containing the circuit IDs of the gates to be used as input.
+     * \param combine is the associative operation of the gate (and2, or2 or xor2)
+     * \param neutral is the neutral element of combine, the second operand of a gate with one input
+     * \return the two remaining operands, to be combined by the final operation of the gate
+     *
+     */
+    std::pair<ClassProject::BDD_ID, ClassProject::BDD_ID>
+    ReduceInputs(span_t<unique_ID_t> inputNodes,
+                 ClassProject::BDD_ID (ClassProject::ManagerInterface::*combine)(ClassProject::BDD_ID, ClassProject::BDD_ID),
+                 ClassProject::BDD_ID neutral);
+
+    /**
+     * \brief Returns the number of nodes of a BDD, including its terminal nodes.
+     * \param root is ClassProject::BDD_ID
+     * \return size_t, counted in linear time by a ClassProject::Manager
+     *
+     */
+    size_t BddSize(ClassProject::BDD_ID root);
 
     void dumpBddText(std::ostream &out);
 
@@ -0,0 +1,55 @@
+#include "CircuitToReachability.hpp"
+
+
+CircuitToReachability::CircuitToReachability(BenchParser &parsed_circuit, const std::string &benchmark_file) {
+
+    auto flip_flops = parsed_circuit.GetListOfFlipFlops();
+    input_labels = parsed_circuit.GetListOfInputLabels();
+
+    if (flip_flops.empty()) {
+        throw std::runtime_error("CircuitToReachability: the circuit has no flip flops!");
+    }
+
+    reachability = make_shared<ClassProject::Reachability>(flip_flops.size(), input_labels.size());
+
+    /* The FLIP FLOP outputs and primary inputs of the circuit are the state and input variables */
+    std::unordered_map<label_t, ClassProject::BDD_ID> variables;
+
+    for (size_t i = 0; i < flip_flops.size(); i++) {
+        state_labels.push_back(flip_flops[i].first);
+        variables[flip_flops[i].first] = reachability->getStates()[i];
+    }
+    for (size_t i = 0; i < input_labels.size(); i++) {
+        variables[input_labels[i]] = reachability->getInputs()[i];
+    }
+
+    /* Merge duplicate gates and simplify the circuit before any BDD operation */
+    StructuralHasher hashed_circuit(parsed_circuit.GetSortedCircuit());
+
+    CircuitToBDD circuit2BDD(reachability);
+    circuit2BDD.SetInputVariables(variables);
+    circuit2BDD.GenerateBDD(hashed_circuit.GetSortedCircuit(), benchmark_file);
+
+    /* The next state of each FLIP FLOP is the function at its data input */
+    std::vector<ClassProject::BDD_ID> transition_functions;
+
+    for (const auto &flip_flop : flip_flops) {
+        transition_functions.push_back(circuit2BDD.GetBddId(flip_flop.second));
+    }
+
+    reachability->setTransitionFunctions(transition_functions);
+}
+
+CircuitToReachability::~CircuitToReachability() = default;
+
+shared_ptr<ClassProject::Reachability> CircuitToReachability::GetReachability() {
+    return reachability;
+}
+
+const std::vector<label_t> &CircuitToReachability::GetStateLabels() const {
+    return state_labels;
+}
+
+const std::vector<label_t> &CircuitToReachability::GetInputLabels() const {
+    return input_labels;
+}
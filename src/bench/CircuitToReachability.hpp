@@ -0,0 +1,68 @@
+#pragma once
+
+#include "BenchParser.hpp"
+#include "CircuitToBDD.hpp"
+#include "StructuralHasher.hpp"
+#include "Reachability.h"
+
+#include <memory>
+#include <vector>
+
+
+/**
+ * \class CircuitToReachability
+ *
+ * \brief Class to convert a sequential circuit into a state machine
+ *
+ *  Every FLIP FLOP of an ISCAS89 circuit, or latch of an AIGER file, becomes
+ *  a state bit and every primary INPUT an input variable of a
+ *  ClassProject::Reachability instance.
+ *  The transition function of a state bit is the BDD of the data input
+ *  of its FLIP FLOP. All FLIP FLOPS are initially reset to 0.
+ *
+ */
+class CircuitToReachability {
+
+public:
+
+    /**
+     * \brief Builds the state machine of the given circuit
+     * \param parsed_circuit is the circuit read from the bench file
+     * \param benchmark_file is the path to the bench file, naming the result directory
+     *
+     */
+    CircuitToReachability(BenchParser &parsed_circuit, const std::string &benchmark_file);
+
+    ~CircuitToReachability();
+
+    /**
+     * \brief return the state machine of the circuit
+     * \param none
+     * \return shared_ptr<ClassProject::Reachability>
+     *
+     */
+    shared_ptr<ClassProject::Reachability> GetReachability();
+
+    /**
+     * \brief return the FLIP FLOP labels, the label at index i belongs to state bit i
+     * \param none
+     * \return std::vector<label_t>
+     *
+     */
+    const std::vector<label_t> &GetStateLabels() const;
+
+    /**
+     * \brief return the primary INPUT labels, the label at index i belongs to input i
+     * \param none
+     * \return std::vector<label_t>
+     *
+     */
+    const std::vector<label_t> &GetInputLabels() const;
+
+private:
+
+    shared_ptr<ClassProject::Reachability> reachability{};
+
+    std::vector<label_t> state_labels;
+    std::vector<label_t> input_labels;
+};
@@ -0,0 +1,280 @@
+//
+// Structural hashing of sorted circuits before BDD construction
+//
+
+#include "StructuralHasher.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+    /* Gate keys start with a tag, followed by the sorted input literals */
+    constexpr uint64_t AND_KEY = 0;
+    constexpr uint64_t XOR_KEY = 1;
+
+    struct gate_key_hash_t {
+        size_t operator()(const std::vector<uint64_t> &key) const {
+            uint64_t hash = 14695981039346656037ULL;
+            for (uint64_t word : key) {
+                hash = (hash ^ word) * 1099511628211ULL;
+            }
+            return hash;
+        }
+    };
+}
+
+StructuralHasher::StructuralHasher(const sorted_circuit_t &circuit) {
+    const size_t node_count = circuit.size();
+
+    std::vector<literal_t> node_literal(node_count);               ///< Function of each node
+    std::unordered_map<literal_t, unique_ID_t> literal_node;       ///< First node computing a literal
+    std::unordered_map<std::vector<uint64_t>, literal_t, gate_key_hash_t> gate_table;
+
+    circuit_nodes.reserve(node_count);
+    input_offsets.assign(1, 0);
+
+    std::vector<literal_t> literals;
+    std::vector<uint64_t> key;
+    for (const auto &node : circuit) {
+        const unique_ID_t id = node.id;
+        const literal_t own_literal = 2 * (id + 1);
+
+        literals.clear();
+        for (unique_ID_t input : node.input_id_list) {
+            literals.push_back(node_literal[input]);
+        }
+
+        /* The function of the node as a literal. A node that is not an alias
+           of another literal computes its own literal from emitted_inputs. */
+        literal_t value = own_literal;
+        std::vector<literal_t> emitted_inputs;
+        bool keep_original = false;
+
+        switch (node.gate_type) {
+            case gate_type_t::Input:
+            case gate_type_t::Output:
+            case gate_type_t::FlipFlop:
+                keep_original = true;
+                break;
+            case gate_type_t::Zero:
+                value = 0;
+                break;
+            case gate_type_t::Buffer:
+                value = literals.front();
+                break;
+            case gate_type_t::Not:
+                value = literals.front() ^ 1;
+                break;
+            case gate_type_t::And:
+            case gate_type_t::Nand:
+            case gate_type_t::Or:
+            case gate_type_t::Nor: {
+                /* OR(a, b) = NOT AND(NOT a, NOT b), so all four are an AND of the literals in and_inputs */
+                const bool or_type = (node.gate_type == gate_type_t::Or) || (node.gate_type == gate_type_t::Nor);
+                const bool inverted = (node.gate_type == gate_type_t::Nand) || (node.gate_type == gate_type_t::Or);
+                std::vector<literal_t> and_inputs;
+                bool is_false = false;
+                for (literal_t literal : literals) {
+                    literal ^= or_type ? 1 : 0;
+                    if (literal == 0) {
+                        is_false = true;
+                    } else if (literal != 1) {
+                        and_inputs.push_back(literal);
+                    }
+                }
+                std::sort(and_inputs.begin(), and_inputs.end());
+                and_inputs.erase(std::unique(and_inputs.begin(), and_inputs.end()), and_inputs.end());
+                for (size_t i = 1; i < and_inputs.size(); i++) {
+                    /* x and NOT x are neighbours after sorting */
+                    is_false = is_false || ((and_inputs[i] ^ 1) == and_inputs[i - 1]);
+                }
+
+                literal_t and_value;
+                if (is_false) {
+                    and_value = 0;
+                } else if (and_inputs.empty()) {
+                    and_value = 1;
+                } else if (and_inputs.size() == 1) {
+                    and_value = and_inputs.front();
+                } else {
+                    key.assign(1, AND_KEY);
+                    key.insert(key.end(), and_inputs.begin(), and_inputs.end());
+                    auto got = gate_table.find(key);
+                    if (got != gate_table.end()) {
+                        and_value = got->second;
+                    } else {
+                        and_value = own_literal ^ (inverted ? 1 : 0);
+                        gate_table.emplace(key, and_value);
+                        /* The remaining inputs keep their order, which decides the order of the apply calls */
+                        for (literal_t literal : literals) {
+                            if ((literal > 1) && (std::find(emitted_inputs.begin(), emitted_inputs.end(), literal) ==
+                                                  emitted_inputs.end())) {
+                                emitted_inputs.push_back(literal);
+                            }
+                        }
+                    }
+                }
+                value = and_value ^ (inverted ? 1 : 0);
+                break;
+            }
+            case gate_type_t::Xor: {
+                /* XOR of the positive literals, inverted by polarity */
+                std::vector<literal_t> xor_inputs;
+                literal_t polarity = 0;
+                for (literal_t literal : literals) {
+                    polarity ^= literal & 1;
+                    if (literal > 1) {
+                        xor_inputs.push_back(literal & ~literal_t(1));
+                    }
+                }
+                std::sort(xor_inputs.begin(), xor_inputs.end());
+                std::vector<literal_t> odd_inputs;
+                for (literal_t literal : xor_inputs) {
+                    /* x XOR x cancels out */
+                    if (!odd_inputs.empty() && (odd_inputs.back() == literal)) {
+                        odd_inputs.pop_back();
+                    } else {
+                        odd_inputs.push_back(literal);
+                    }
+                }
+
+                if (odd_inputs.empty()) {
+                    value = polarity;
+                } else if (odd_inputs.size() == 1) {
+                    value = odd_inputs.front() ^ polarity;
+                } else {
+                    key.assign(1, XOR_KEY);
+                    key.insert(key.end(), odd_inputs.begin(), odd_inputs.end());
+                    auto got = gate_table.find(key);
+                    if (got != gate_table.end()) {
+                        value = got->second ^ polarity;
+                    } else {
+                        gate_table.emplace(key, own_literal ^ polarity);
+                        for (literal_t literal : literals) {
+                            literal &= ~literal_t(1);
+                            if (std::binary_search(odd_inputs.begin(), odd_inputs.end(), literal) &&
+                                (std::find(emitted_inputs.begin(), emitted_inputs.end(), literal) ==
+                                 emitted_inputs.end())) {
+                                emitted_inputs.push_back(literal);
+                            }
+                        }
+
+                        /* The polarity moves to the first input whose complement exists */
+                        if (polarity == 1) {
+                            auto inverted_input = std::find_if(
+                                    emitted_inputs.begin(), emitted_inputs.end(),
+                                    [&literal_node](literal_t literal) { return literal_node.count(literal ^ 1) != 0; });
+                            if (inverted_input != emitted_inputs.end()) {
+                                *inverted_input ^= 1;
+                            } else {
+                                emitted_inputs.clear();
+                                keep_original = true;
+                            }
+                        }
+                    }
+                }
+                break;
+            }
+        }
+
+        /* Emit the node, reusing an existing node for its literal whenever possible */
+        circuit_node_t new_node = node;
+        if (keep_original) {
+            for (unique_ID_t input : node.input_id_list) {
+                input_ids.push_back(input);
+            }
+        } else if (value == own_literal) {
+            for (literal_t literal : emitted_inputs) {
+                input_ids.push_back(literal_node.at(literal));
+            }
+        } else {
+            auto got = literal_node.find(value);
+            if (got != literal_node.end()) {
+                new_node.gate_type = gate_type_t::Buffer;
+                input_ids.push_back(got->second);
+            } else if (value == 0) {
+                new_node.gate_type = gate_type_t::Zero;
+            } else if (literal_node.count(value ^ 1) != 0) {
+                new_node.gate_type = gate_type_t::Not;
+                input_ids.push_back(literal_node.at(value ^ 1));
+            } else {
+                /* TRUE without any constant node yet */
+                for (unique_ID_t input : node.input_id_list) {
+                    input_ids.push_back(input);
+                }
+            }
+        }
+        literal_node.emplace(value, id);
+        node_literal[id] = value;
+
+        if (IsLogicGate(node.gate_type)) {
+            gate_count++;
+            if ((new_node.gate_type == gate_type_t::Buffer) || (new_node.gate_type == gate_type_t::Zero)) {
+                eliminated_gate_count++;
+            }
+        }
+        circuit_nodes.push_back(new_node);
+        input_offsets.push_back(input_ids.size());
+    }
+
+    BuildAdjacency();
+}
+
+sorted_circuit_t StructuralHasher::GetSortedCircuit() {
+    return sorted_circuit_t(circuit_nodes.data(), circuit_nodes.size());
+}
+
+size_t StructuralHasher::GetNumberOfGates() const {
+    return gate_count;
+}
+
+size_t StructuralHasher::GetNumberOfEliminatedGates() const {
+    return eliminated_gate_count;
+}
+
+void StructuralHasher::BuildAdjacency() {
+    const size_t node_count = circuit_nodes.size();
+
+    /* Count the outputs of every node, then place them with a counting sort */
+    output_offsets.assign(node_count + 1, 0);
+    for (unique_ID_t input : input_ids) {
+        output_offsets[input + 1]++;
+    }
+    for (size_t i = 0; i < node_count; i++) {
+        output_offsets[i + 1] += output_offsets[i];
+    }
+    output_ids.resize(input_ids.size());
+    std::vector<size_t> output_end(output_offsets.begin(), output_offsets.end() - 1);
+    for (unique_ID_t node = 0; node < node_count; node++) {
+        for (size_t i = input_offsets[node]; i < input_offsets[node + 1]; i++) {
+            output_ids[output_end[input_ids[i]]++] = node;
+        }
+    }
+
+    /* Removed inputs can lower the level of a node */
+    for (auto &circuit_node : circuit_nodes) {
+        const unique_ID_t id = circuit_node.id;
+        circuit_node.input_id_list = span_t<unique_ID_t>(input_ids.data() + input_offsets[id],
+                                                         input_offsets[id + 1] - input_offsets[id]);
+        circuit_node.output_id_list = span_t<unique_ID_t>(output_ids.data() + output_offsets[id],
+                                                          output_offsets[id + 1] - output_offsets[id]);
+        circuit_node.level = 0;
+        for (unique_ID_t input : circuit_node.input_id_list) {
+            circuit_node.level = std::max(circuit_node.level, circuit_nodes[input].level + 1);
+        }
+    }
+}
+
+bool StructuralHasher::IsLogicGate(gate_type_t gate_type) {
+    switch (gate_type) {
+        case gate_type_t::Not:
+        case gate_type_t::And:
+        case gate_type_t::Or:
+        case gate_type_t::Nand:
+        case gate_type_t::Nor:
+        case gate_type_t::Xor:
+            return true;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,95 @@
+//
+// Structural hashing of sorted circuits before BDD construction
+//
+
+#pragma once
+
+#include "BenchParser.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * \class StructuralHasher
+ *
+ * \brief Merges structurally identical gates and simplifies gates locally.
+ *
+ *  Every node is assigned an AIG literal: a representative node and an
+ *  inversion flag, or a constant. Gates are simplified on these literals:
+ *      - BUFF chains and double inverters collapse to their source
+ *      - constant inputs are propagated, x and NOT x cancel out
+ *      - repeated inputs are removed
+ *      - AND/NAND/OR/NOR over the same literals, with OR(a, b) hashed as
+ *        NOT AND(NOT a, NOT b), and XOR up to the polarity of its inputs
+ *        are looked up in a hash table
+ *  A gate whose function already exists becomes a BUFF of the existing
+ *  node, or a NOT if only its complement exists, so it costs no apply call
+ *  or only a negation. The remaining gates keep their type and lose their
+ *  redundant inputs.
+ *
+ *  The result has the same nodes, IDs and labels as the input circuit and
+ *  every node keeps its function, so CircuitToBDD can use it directly.
+ *  The labels are views into the BenchParser, which must outlive the hasher.
+ *
+ */
+class StructuralHasher {
+public:
+    /**
+     * \brief Constructor
+     * \param circuit is the topologically sorted circuit to simplify
+     *
+     */
+    explicit StructuralHasher(const sorted_circuit_t &circuit);
+
+    /* The circuit nodes point into the arrays of the hasher, so it cannot be copied */
+    StructuralHasher(const StructuralHasher &) = delete;
+
+    StructuralHasher &operator=(const StructuralHasher &) = delete;
+
+    /**
+     * \brief return the simplified circuit.
+     * \param none
+     * \return sorted_circuit_t, valid as long as the hasher exists
+     *
+     */
+    sorted_circuit_t GetSortedCircuit();
+
+    /**
+     * \brief return the number of logic gates (NOT, AND, OR, NAND, NOR, XOR) of the input circuit.
+     * \param none
+     * \return size_t
+     *
+     */
+    size_t GetNumberOfGates() const;
+
+    /**
+     * \brief return the number of logic gates that were replaced by a BUFF or a constant.
+     * \param none
+     * \return size_t
+     *
+     */
+    size_t GetNumberOfEliminatedGates() const;
+
+private:
+    typedef uint64_t literal_t; ///< 0 is FALSE, 1 is TRUE, 2 * (id + 1) + c is node id, inverted if c is 1
+
+    std::vector<circuit_node_t> circuit_nodes;
+    std::vector<size_t> input_offsets;   ///< The inputs of node i are input_ids[input_offsets[i]] to input_ids[input_offsets[i + 1] - 1]
+    std::vector<unique_ID_t> input_ids;
+    std::vector<size_t> output_offsets;  ///< The outputs of node i, stored like the inputs
+    std::vector<unique_ID_t> output_ids;
+
+    size_t gate_count = 0;
+    size_t eliminated_gate_count = 0;
+
+    /**
+     * \brief builds the output arrays and the views of all nodes.
+     * \param none
+     * \return none
+     *
+     */
+    void BuildAdjacency();
+
+    static bool IsLogicGate(gate_type_t gate_type);
+};
@@ -0,0 +1,423 @@
+#ifndef VDSPROJECT_BENCH_TESTS_H
+#define VDSPROJECT_BENCH_TESTS_H
+
+#include <gtest/gtest.h>
+#include "AigerReader.hpp"
+#include "BenchParser.hpp"
+#include "StructuralHasher.hpp"
+#include "VariableOrder.hpp"
+#include "../Manager.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+using ClassProject::BDD_ID;
+
+/* Writes circuit files into the temporary directory and parses them */
+struct BenchFileTest : testing::Test {
+    std::vector<std::filesystem::path> files;
+    std::vector<std::unique_ptr<BenchParser>> parsers;
+
+    /* The extension of file_name selects the format */
+    BenchParser &Parse(const std::string &file_name, const std::string &content) {
+        const std::string test_name = testing::UnitTest::GetInstance()->current_test_info()->name();
+        files.push_back(std::filesystem::temp_directory_path() / ("vdsproject_" + test_name + "_" + file_name));
+        std::ofstream(files.back(), std::ios::binary) << content;
+        parsers.push_back(std::make_unique<BenchParser>(files.back().string(), false));
+        return *parsers.back();
+    }
+
+    void TearDown() override {
+        parsers.clear();
+        for (const auto &file : files) {
+            std::filesystem::remove(file);
+        }
+    }
+
+    /* The gate computing a label, not the OUTPUT node of the same name */
+    static const circuit_node_t &Gate(const sorted_circuit_t &circuit, std::string_view label) {
+        for (const auto &circuit_node : circuit) {
+            if ((circuit_node.label == label) && (circuit_node.gate_type != gate_type_t::Output)) {
+                return circuit_node;
+            }
+        }
+        throw std::runtime_error("There is no gate with the label " + std::string(label) + "!");
+    }
+
+    static std::vector<std::string_view> InputLabels(const sorted_circuit_t &circuit, const circuit_node_t &node) {
+        std::vector<std::string_view> labels;
+        for (unique_ID_t input : node.input_id_list) {
+            labels.push_back(circuit[input].label);
+        }
+        return labels;
+    }
+
+    /* BDD of every node, with the variable of INPUT node id at variables[id] */
+    static std::vector<BDD_ID> NodeFunctions(ClassProject::Manager &manager, const sorted_circuit_t &circuit,
+                                             const std::vector<BDD_ID> &variables) {
+        std::vector<BDD_ID> functions(circuit.size());
+        for (const auto &circuit_node : circuit) {
+            BDD_ID (ClassProject::Manager::*combine)(BDD_ID, BDD_ID) = &ClassProject::Manager::and2;
+            BDD_ID function = manager.True();
+            bool inverted = false;
+
+            switch (circuit_node.gate_type) {
+                case gate_type_t::Input:
+                    functions[circuit_node.id] = variables[circuit_node.id];
+                    continue;
+                case gate_type_t::Zero:
+                    functions[circuit_node.id] = manager.False();
+                    continue;
+                case gate_type_t::Not:
+                case gate_type_t::Nand:
+                    inverted = true;
+                    break;
+                case gate_type_t::Or:
+                    combine = &ClassProject::Manager::or2;
+                    function = manager.False();
+                    break;
+                case gate_type_t::Nor:
+                    combine = &ClassProject::Manager::or2;
+                    function = manager.False();
+                    inverted = true;
+                    break;
+                case gate_type_t::Xor:
+                    combine = &ClassProject::Manager::xor2;
+                    function = manager.False();
+                    break;
+                default:
+                    break;
+            }
+            for (unique_ID_t input : circuit_node.input_id_list) {
+                function = (manager.*combine)(function, functions[input]);
+            }
+            functions[circuit_node.id] = inverted ? manager.neg(function) : function;
+        }
+        return functions;
+    }
+};
+
+const char C17[] =
+        "INPUT(1)\n"
+        "INPUT(2)\n"
+        "INPUT(3)\n"
+        "INPUT(6)\n"
+        "INPUT(7)\n"
+        "OUTPUT(22)\n"
+        "OUTPUT(23)\n"
+        "10 = NAND(1, 3)\n"
+        "11 = NAND(3, 6)\n"
+        "16 = NAND(2, 11)\n"
+        "19 = NAND(11, 7)\n"
+        "22 = NAND(10, 16)\n"
+        "23 = NAND(16, 19)\n";
+
+TEST_F(BenchFileTest, SortsInputsInFileOrder) {
+    /* The circuit is built from the outputs, which reaches 3 before 2 */
+    BenchParser &parser = Parse("c17.bench", C17);
+
+    std::vector<label_t> level_0;
+    for (const auto &circuit_node : parser.GetLevel(0)) {
+        level_0.emplace_back(circuit_node.label);
+    }
+    EXPECT_EQ(level_0, parser.GetListOfInputLabels());
+    EXPECT_EQ(level_0, std::vector<label_t>({"1", "2", "3", "6", "7"}));
+}
+
+TEST_F(BenchFileTest, CacheTellsApartFilesWithTheSameStem) {
+    /* Same stem, size and modification time, but 10 reads 2 instead of 3 */
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "vdsproject_cache_test";
+    std::string other = C17;
+    other.replace(other.find("NAND(1, 3)"), 10, "NAND(1, 2)");
+    std::filesystem::create_directories(directory / "a");
+    std::filesystem::create_directories(directory / "b");
+    std::ofstream(directory / "a" / "vdsproject_cache_test.bench", std::ios::binary) << C17;
+    std::ofstream(directory / "b" / "vdsproject_cache_test.bench", std::ios::binary) << other;
+    std::filesystem::last_write_time(directory / "b" / "vdsproject_cache_test.bench",
+                                     std::filesystem::last_write_time(directory / "a" / "vdsproject_cache_test.bench"));
+
+    std::vector<std::vector<std::string_view>> inputs_of_10;
+    for (const char *name : {"a", "b", "a"}) {
+        BenchParser parser((directory / name / "vdsproject_cache_test.bench").string(), true);
+        const sorted_circuit_t circuit = parser.GetSortedCircuit();
+        inputs_of_10.push_back(InputLabels(circuit, Gate(circuit, "10")));
+    }
+    std::filesystem::remove_all(directory);
+    std::filesystem::remove_all("results_vdsproject_cache_test");
+
+    EXPECT_EQ(inputs_of_10[0], std::vector<std::string_view>({"1", "3"}));
+    EXPECT_EQ(inputs_of_10[1], std::vector<std::string_view>({"1", "2"}));
+    EXPECT_EQ(inputs_of_10[2], std::vector<std::string_view>({"1", "3"}));
+}
+
+struct StructuralHasherTest : BenchFileTest {
+    /* Every node of the hashed circuit computes the function of the same node in the original circuit */
+    static void ExpectSameFunctions(const sorted_circuit_t &original, const sorted_circuit_t &hashed) {
+        ASSERT_EQ(hashed.size(), original.size());
+
+        ClassProject::Manager manager;
+        std::vector<BDD_ID> variables(original.size());
+        for (const auto &circuit_node : original) {
+            if (circuit_node.gate_type == gate_type_t::Input) {
+                variables[circuit_node.id] = manager.createVar(std::string(circuit_node.label));
+            }
+        }
+        EXPECT_EQ(NodeFunctions(manager, hashed, variables), NodeFunctions(manager, original, variables));
+    }
+};
+
+TEST_F(StructuralHasherTest, MergesDuplicateGates) {
+    /* The duplicates lie on higher levels than the gates they merge into */
+    BenchParser &parser = Parse("circuit.bench",
+          "INPUT(a)\n"
+          "INPUT(b)\n"
+          "OUTPUT(g1)\n"
+          "OUTPUT(g2)\n"
+          "OUTPUT(n1)\n"
+          "OUTPUT(o1)\n"
+          "OUTPUT(h1)\n"
+          "OUTPUT(h2)\n"
+          "ga = BUFF(a)\n"
+          "g1 = AND(a, b)\n"
+          "g2 = AND(b, ga)\n"
+          "n1 = NAND(ga, b)\n"
+          "na = NOT(ga)\n"
+          "nb = NOT(b)\n"
+          "o1 = OR(na, nb)\n"
+          "h1 = OR(a, b)\n"
+          "h2 = NOR(b, ga)\n");
+    StructuralHasher hasher(parser.GetSortedCircuit());
+    const sorted_circuit_t circuit = hasher.GetSortedCircuit();
+
+    EXPECT_EQ(Gate(circuit, "g2").gate_type, gate_type_t::Buffer);
+    EXPECT_EQ(InputLabels(circuit, Gate(circuit, "g2")), std::vector<std::string_view>({"g1"}));
+
+    /* Only the complement exists */
+    EXPECT_EQ(Gate(circuit, "n1").gate_type, gate_type_t::Not);
+    EXPECT_EQ(InputLabels(circuit, Gate(circuit, "n1")), std::vector<std::string_view>({"g1"}));
+    EXPECT_EQ(Gate(circuit, "h2").gate_type, gate_type_t::Not);
+    EXPECT_EQ(InputLabels(circuit, Gate(circuit, "h2")), std::vector<std::string_view>({"h1"}));
+
+    /* OR(NOT a, NOT b) is hashed as NOT AND(a, b) */
+    EXPECT_EQ(Gate(circuit, "o1").gate_type, gate_type_t::Buffer);
+    EXPECT_EQ(InputLabels(circuit, Gate(circuit, "o1")), std::vector<std::string_view>({"n1"}));
+
+    EXPECT_EQ(hasher.GetNumberOfGates(), 8u);
+    EXPECT_EQ(hasher.GetNumberOfEliminatedGates(), 2u);
+    ExpectSameFunctions(parser.GetSortedCircuit(), circuit);
+}
+
+TEST_F(StructuralHasherTest, SimplifiesInvertersAndContradictions) {
+    BenchParser &parser = Parse("circuit.bench",
+          "INPUT(a)\n"
+          "INPUT(b)\n"
+          "OUTPUT(n2)\n"
+          "OUTPUT(z)\n"
+          "OUTPUT(g)\n"
+          "n1 = NOT(a)\n"
+          "n2 = NOT(n1)\n"
+          "z = AND(a, b, n1)\n"
+          "g = AND(n2, b)\n");
+    StructuralHasher hasher(parser.GetSortedCircuit());
+    const sorted_circuit_t circuit = hasher.GetSortedCircuit();
+
+    /* NOT NOT a is a */
+    EXPECT_EQ(Gate(circuit, "n2").gate_type, gate_type_t::Buffer);
+    EXPECT_EQ(InputLabels(circuit, Gate(circuit, "n2")), std::vector<std::string_view>({"a"}));
+    EXPECT_EQ(InputLabels(circuit, Gate(circuit, "g")), std::vector<std::string_view>({"a", "b"}));
+
+    /* a AND NOT a is FALSE */
+    EXPECT_EQ(Gate(circuit, "z").gate_type, gate_type_t::Zero);
+    EXPECT_TRUE(Gate(circuit, "z").input_id_list.empty());
+
+    EXPECT_EQ(hasher.GetNumberOfEliminatedGates(), 2u);
+    ExpectSameFunctions(parser.GetSortedCircuit(), circuit);
+}
+
+TEST_F(StructuralHasherTest, MovesXorPolarity) {
+    BenchParser &parser = Parse("circuit.bench",
+          "INPUT(a)\n"
+          "INPUT(b)\n"
+          "OUTPUT(na)\n"
+          "OUTPUT(x1)\n"
+          "OUTPUT(x2)\n"
+          "na = NOT(a)\n"
+          "nb = NOT(b)\n"
+          "x1 = XOR(a, nb)\n"
+          "ga = BUFF(a)\n"
+          "gga = BUFF(ga)\n"
+          "x2 = XOR(b, gga)\n");
+    StructuralHasher hasher(parser.GetSortedCircuit());
+    const sorted_circuit_t circuit = hasher.GetSortedCircuit();
+
+    /* The inversion moves to the first input with an existing complement */
+    EXPECT_EQ(Gate(circuit, "x1").gate_type, gate_type_t::Xor);
+    EXPECT_EQ(InputLabels(circuit, Gate(circuit, "x1")), std::vector<std::string_view>({"na", "b"}));
+
+    /* a XOR b is the complement of x1 */
+    EXPECT_EQ(Gate(circuit, "x2").gate_type, gate_type_t::Not);
+    EXPECT_EQ(InputLabels(circuit, Gate(circuit, "x2")), std::vector<std::string_view>({"x1"}));
+
+    ExpectSameFunctions(parser.GetSortedCircuit(), circuit);
+}
+
+/* An AND of two inputs, one of them inverted, and a latch storing it */
+const char AIGER_ASCII[] =
+        "aag 4 2 1 2 1\n"
+        "2\n"
+        "4\n"
+        "6 8\n"
+        "8\n"
+        "7\n"
+        "8 2 5\n"
+        "i0 x\n"
+        "i1 x\n"
+        "l0 state\n"
+        "o0 f\n"
+        "c\n"
+        "comment\n";
+
+/* The same graph, with the AND gate stored as the differences 8 - 5 and 5 - 2 */
+const char AIGER_BINARY[] =
+        "aig 4 2 1 2 1\n"
+        "8\n"
+        "8\n"
+        "7\n"
+        "\x03\x03"
+        "i0 x\n"
+        "i1 x\n"
+        "l0 state\n"
+        "o0 f\n"
+        "c\n"
+        "comment\n";
+
+struct AigerReaderTest : BenchFileTest {
+    /* The statements as "label = TYPE(inputs)" with sorted inputs, in sorted order */
+    static std::vector<std::string> ReadStatements(std::string_view data, std::string &error) {
+        bench_format::LabelPool labels;
+        bench_format::AigerReader reader(data, labels);
+        std::vector<bench_format::bench_node_type> statements;
+        std::vector<std::string> lines;
+        if (!reader.ReadStatements(statements)) {
+            error = reader.GetError();
+            return lines;
+        }
+
+        for (const auto &statement : statements) {
+            std::vector<std::string> inputs;
+            for (bench_format::label_id_t input : statement.input_node_list) {
+                inputs.push_back(labels.GetLabel(input));
+            }
+            std::sort(inputs.begin(), inputs.end());
+
+            std::string line = labels.GetLabel(statement.label) + " = " +
+                               bench_format::GateTypeName(statement.gate_type) + "(";
+            for (size_t i = 0; i < inputs.size(); i++) {
+                line += ((i == 0) ? "" : ", ") + inputs[i];
+            }
+            lines.push_back(line + ")");
+        }
+        std::sort(lines.begin(), lines.end());
+        return lines;
+    }
+};
+
+TEST_F(AigerReaderTest, ReadsAsciiAndBinaryAlike) {
+    std::string error;
+    const std::vector<std::string> ascii = ReadStatements({AIGER_ASCII, sizeof(AIGER_ASCII) - 1}, error);
+    const std::vector<std::string> binary = ReadStatements({AIGER_BINARY, sizeof(AIGER_BINARY) - 1}, error);
+    EXPECT_EQ(error, "");
+
+    /* The second input falls back to its position since "x" is taken, and so does the unnamed output */
+    const std::vector<std::string> expected = {
+            "a4 = AND(i1_n, x)",
+            "f = BUFF(a4)",
+            "f = OUTPUT()",
+            "i1 = INPUT()",
+            "i1_n = NOT(i1)",
+            "o1 = BUFF(state_n)",
+            "o1 = OUTPUT()",
+            "state = DFF(a4)",
+            "state_n = NOT(state)",
+            "x = INPUT()"};
+    EXPECT_EQ(ascii, expected);
+    EXPECT_EQ(binary, expected);
+}
+
+TEST_F(AigerReaderTest, ParsesAigerFiles) {
+    for (BenchParser *parser : {&Parse("circuit.aag", AIGER_ASCII),
+                                &Parse("circuit.aig", std::string(AIGER_BINARY, sizeof(AIGER_BINARY) - 1))}) {
+        EXPECT_EQ(parser->GetListOfInputLabels(), std::vector<label_t>({"x", "i1"}));
+        EXPECT_EQ(parser->GetListOfOutputLabels(), std::set<label_t>({"a4", "f", "o1"}));
+        EXPECT_EQ(parser->GetListOfFlipFlops(), (std::vector<std::pair<label_t, label_t>>({{"state", "a4"}})));
+    }
+}
+
+TEST_F(AigerReaderTest, RejectsLatchesNotResetToZero) {
+    std::string error;
+    EXPECT_TRUE(ReadStatements("aag 1 0 1 0 0\n2 2 1\n", error).empty());
+    EXPECT_EQ(error, "latch 0 is not reset to 0");
+
+    /* An uninitialized latch is reset to its own literal */
+    error.clear();
+    EXPECT_TRUE(ReadStatements("aag 1 0 1 0 0\n2 2 2\n", error).empty());
+    EXPECT_EQ(error, "latch 0 is not reset to 0");
+
+    EXPECT_TRUE(ReadStatements("aag 1 0 1 0 0\n2 2 0\n", error).size() == 1);
+    EXPECT_THROW(Parse("latch.aag", "aag 1 0 1 0 0\n2 3 1\n"), std::runtime_error);
+}
+
+const char S27[] =
+        "INPUT(G0)\n"
+        "INPUT(G1)\n"
+        "INPUT(G2)\n"
+        "INPUT(G3)\n"
+        "OUTPUT(G17)\n"
+        "G5 = DFF(G10)\n"
+        "G6 = DFF(G11)\n"
+        "G7 = DFF(G13)\n"
+        "G14 = NOT(G0)\n"
+        "G17 = NOT(G11)\n"
+        "G8 = AND(G14, G6)\n"
+        "G15 = OR(G12, G8)\n"
+        "G16 = OR(G3, G8)\n"
+        "G9 = NAND(G16, G15)\n"
+        "G10 = NOR(G14, G11)\n"
+        "G11 = NOR(G5, G9)\n"
+        "G12 = NOR(G1, G7)\n"
+        "G13 = NOR(G2, G12)\n";
+
+TEST_F(BenchFileTest, VariableOrderPermutesInputs) {
+    for (BenchParser *parser : {&Parse("c17.bench", C17), &Parse("s27.bench", S27)}) {
+        std::vector<label_t> inputs = parser->GetListOfInputLabels();
+        for (const auto &flip_flop : parser->GetListOfFlipFlops()) {
+            inputs.push_back(flip_flop.first);
+        }
+
+        for (auto heuristic : {VariableOrder::heuristic_t::Circuit, VariableOrder::heuristic_t::DepthFirst,
+                               VariableOrder::heuristic_t::Force, VariableOrder::heuristic_t::Weight}) {
+            std::vector<label_t> order = VariableOrder(parser->GetSortedCircuit(), heuristic).GetInputLabels();
+            if (heuristic == VariableOrder::heuristic_t::Circuit) {
+                /* The INPUT lines, then the FLIP FLOP outputs */
+                EXPECT_EQ(std::vector<label_t>(order.begin(), order.begin() + parser->GetListOfInputLabels().size()),
+                          parser->GetListOfInputLabels());
+            }
+            std::sort(order.begin(), order.end());
+            std::vector<label_t> expected = inputs;
+            std::sort(expected.begin(), expected.end());
+            EXPECT_EQ(order, expected) << VariableOrder::HeuristicName(heuristic);
+        }
+    }
+}
+
+TEST_F(BenchFileTest, VariableOrderDepthFirst) {
+    BenchParser &parser = Parse("c17.bench", C17);
+
+    /* Output 22 first, its deeper fan-in 16 before 10, and 11 before 2 below 16 */
+    EXPECT_EQ(VariableOrder(parser.GetSortedCircuit(), VariableOrder::heuristic_t::DepthFirst).GetInputLabels(),
+              std::vector<label_t>({"3", "6", "2", "1", "7"}));
+}
+
+#endif
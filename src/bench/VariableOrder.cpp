@@ -0,0 +1,311 @@
+//
+// Static variable ordering heuristics for sorted circuits
+//
+
+#include "VariableOrder.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+
+VariableOrder::VariableOrder(const sorted_circuit_t &circuit, heuristic_t heuristic) : circuit(circuit) {
+    std::vector<unique_ID_t> node_order;
+
+    switch (heuristic) {
+        case heuristic_t::Circuit:
+            /* The sorted circuit starts with the INPUT nodes in file order */
+            node_order.resize(circuit.size());
+            std::iota(node_order.begin(), node_order.end(), 0);
+            break;
+        case heuristic_t::DepthFirst:
+            node_order = DepthFirstOrder();
+            break;
+        case heuristic_t::Force:
+            node_order = DepthFirstOrder();
+            ForcePlacement(node_order);
+            break;
+        case heuristic_t::Weight:
+            node_order = WeightOrder();
+            break;
+    }
+
+    CollectInputs(node_order);
+}
+
+const std::vector<label_t> &VariableOrder::GetInputLabels() const {
+    return input_labels;
+}
+
+bool VariableOrder::ParseHeuristic(const std::string &name, heuristic_t &heuristic) {
+    for (heuristic_t candidate : {heuristic_t::Circuit, heuristic_t::DepthFirst, heuristic_t::Force,
+                                  heuristic_t::Weight}) {
+        if (name == HeuristicName(candidate)) {
+            heuristic = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *VariableOrder::HeuristicName(heuristic_t heuristic) {
+    switch (heuristic) {
+        case heuristic_t::Circuit:
+            return "circuit";
+        case heuristic_t::DepthFirst:
+            return "dfs";
+        case heuristic_t::Force:
+            return "force";
+        case heuristic_t::Weight:
+            return "weight";
+    }
+    return "";
+}
+
+std::vector<unique_ID_t> VariableOrder::Roots() const {
+    std::vector<unique_ID_t> roots;
+    for (const auto &circuit_node : circuit) {
+        if ((circuit_node.gate_type == gate_type_t::Output) || (circuit_node.gate_type == gate_type_t::FlipFlop)) {
+            roots.push_back(circuit_node.id);
+        }
+    }
+    return roots;
+}
+
+std::vector<unique_ID_t> VariableOrder::DepthFirstOrder() const {
+    const size_t node_count = circuit.size();
+    auto deeper = [this](unique_ID_t a, unique_ID_t b) { return circuit[a].level > circuit[b].level; };
+
+    std::vector<unique_ID_t> roots = Roots();
+    std::stable_sort(roots.begin(), roots.end(), deeper);
+
+    struct frame_t {
+        unique_ID_t id;
+        std::vector<unique_ID_t> fan_in;  ///< Inputs of the node, deepest first
+        size_t next;
+    };
+
+    std::vector<unique_ID_t> node_order;
+    std::vector<bool> visited(node_count, false);
+    std::vector<frame_t> stack;
+    node_order.reserve(node_count);
+
+    auto push = [&](unique_ID_t id) {
+        visited[id] = true;
+        const auto &inputs = circuit[id].input_id_list;
+        stack.push_back({id, std::vector<unique_ID_t>(inputs.begin(), inputs.end()), 0});
+        std::stable_sort(stack.back().fan_in.begin(), stack.back().fan_in.end(), deeper);
+    };
+
+    for (unique_ID_t root : roots) {
+        if (visited[root]) {
+            continue;
+        }
+        push(root);
+        while (!stack.empty()) {
+            frame_t &top = stack.back();
+            if (top.next < top.fan_in.size()) {
+                const unique_ID_t input = top.fan_in[top.next++];
+                if (!visited[input]) {
+                    push(input);
+                }
+            } else {
+                node_order.push_back(top.id);
+                stack.pop_back();
+            }
+        }
+    }
+
+    for (unique_ID_t id = 0; id < node_count; id++) {
+        if (!visited[id]) {
+            node_order.push_back(id);
+        }
+    }
+    return node_order;
+}
+
+void VariableOrder::ForcePlacement(std::vector<unique_ID_t> &node_order) const {
+    const size_t node_count = circuit.size();
+
+    /* The vertices are the INPUT nodes, initially placed in the order of node_order */
+    std::vector<unique_ID_t> inputs;
+    std::vector<size_t> input_index(node_count, node_count);
+    for (unique_ID_t id : node_order) {
+        if (circuit[id].gate_type == gate_type_t::Input) {
+            input_index[id] = inputs.size();
+            inputs.push_back(id);
+        }
+    }
+    const size_t input_count = inputs.size();
+    const size_t words = (input_count + 63) / 64;
+
+    /* Support of every node as a bit set over the vertices, in topological order */
+    std::vector<uint64_t> support(node_count * words, 0);
+    for (const auto &circuit_node : circuit) {
+        uint64_t *bits = &support[circuit_node.id * words];
+        const size_t vertex = input_index[circuit_node.id];
+        if (vertex != node_count) {
+            bits[vertex / 64] |= uint64_t(1) << (vertex % 64);
+        }
+        for (unique_ID_t input : circuit_node.input_id_list) {
+            for (size_t w = 0; w < words; w++) {
+                bits[w] |= support[input * words + w];
+            }
+        }
+    }
+
+    /* Every root forms one hyperedge with the INPUT nodes in its support */
+    std::vector<std::vector<size_t>> edges;
+    std::vector<std::vector<size_t>> vertex_edges(input_count);
+    for (unique_ID_t root : Roots()) {
+        std::vector<size_t> edge;
+        for (size_t vertex = 0; vertex < input_count; vertex++) {
+            if ((support[root * words + vertex / 64] >> (vertex % 64)) & 1) {
+                edge.push_back(vertex);
+            }
+        }
+        if (edge.size() > 1) {
+            for (size_t vertex : edge) {
+                vertex_edges[vertex].push_back(edges.size());
+            }
+            edges.push_back(std::move(edge));
+        }
+    }
+
+    std::vector<double> position(input_count);
+    std::vector<double> center(edges.size());
+    std::vector<double> new_position(input_count);
+
+    auto total_span = [&]() {
+        double span = 0;
+        for (const auto &edge : edges) {
+            double low = position[edge.front()], high = position[edge.front()];
+            for (size_t vertex : edge) {
+                low = std::min(low, position[vertex]);
+                high = std::max(high, position[vertex]);
+            }
+            span += high - low;
+        }
+        return span;
+    };
+
+    std::vector<size_t> placement(input_count);
+    std::iota(placement.begin(), placement.end(), 0);
+    std::iota(position.begin(), position.end(), 0.0);
+    double best_span = total_span();
+
+    /* Iterate until the total span of the hyperedges stops decreasing */
+    std::vector<size_t> candidate = placement;
+    for (size_t iteration = 0; iteration < FORCE_MAX_ITERATIONS; iteration++) {
+        /* Center of gravity of every hyperedge */
+        for (size_t e = 0; e < edges.size(); e++) {
+            double sum = 0;
+            for (size_t vertex : edges[e]) {
+                sum += position[vertex];
+            }
+            center[e] = sum / static_cast<double>(edges[e].size());
+        }
+
+        /* Every vertex moves to the average center of the hyperedges it belongs to */
+        for (size_t vertex = 0; vertex < input_count; vertex++) {
+            double sum = 0;
+            for (size_t e : vertex_edges[vertex]) {
+                sum += center[e];
+            }
+            new_position[vertex] = vertex_edges[vertex].empty() ? position[vertex] :
+                                   sum / static_cast<double>(vertex_edges[vertex].size());
+        }
+
+        /* The new placement keeps the old one for equal positions */
+        std::stable_sort(candidate.begin(), candidate.end(), [&new_position](size_t a, size_t b) {
+            return new_position[a] < new_position[b];
+        });
+        for (size_t i = 0; i < input_count; i++) {
+            position[candidate[i]] = static_cast<double>(i);
+        }
+
+        const double span = total_span();
+        if (span >= best_span) {
+            break;
+        }
+        best_span = span;
+        placement = candidate;
+    }
+
+    node_order.clear();
+    for (size_t vertex : placement) {
+        node_order.push_back(inputs[vertex]);
+    }
+}
+
+std::vector<unique_ID_t> VariableOrder::WeightOrder() const {
+    const size_t node_count = circuit.size();
+    const std::vector<unique_ID_t> roots = Roots();
+
+    size_t input_count = 0;
+    for (const auto &circuit_node : circuit) {
+        input_count += (circuit_node.gate_type == gate_type_t::Input) ? 1 : 0;
+    }
+
+    std::vector<unique_ID_t> node_order;
+    std::vector<bool> removed(node_count, false);
+    std::vector<double> weight(node_count);
+    std::vector<unique_ID_t> pending;
+
+    while (node_order.size() < input_count) {
+        std::fill(weight.begin(), weight.end(), 0.0);
+        for (unique_ID_t root : roots) {
+            weight[root] = 1.0;
+        }
+
+        /* Outputs have larger unique IDs, so one backward pass distributes all weights */
+        for (size_t id = node_count; id-- > 0;) {
+            if ((weight[id] == 0.0) || removed[id]) {
+                continue;
+            }
+            size_t remaining_inputs = 0;
+            for (unique_ID_t input : circuit[id].input_id_list) {
+                remaining_inputs += removed[input] ? 0 : 1;
+            }
+            for (unique_ID_t input : circuit[id].input_id_list) {
+                if (!removed[input]) {
+                    weight[input] += weight[id] / static_cast<double>(remaining_inputs);
+                }
+            }
+        }
+
+        /* The first INPUT with the largest weight, unreached INPUTs have weight 0 */
+        unique_ID_t heaviest = node_count;
+        for (unique_ID_t id = 0; id < node_count; id++) {
+            if ((circuit[id].gate_type == gate_type_t::Input) && !removed[id] &&
+                ((heaviest == node_count) || (weight[id] > weight[heaviest]))) {
+                heaviest = id;
+            }
+        }
+        node_order.push_back(heaviest);
+
+        /* Remove the INPUT and every gate whose inputs are all removed */
+        removed[heaviest] = true;
+        pending.assign(1, heaviest);
+        while (!pending.empty()) {
+            const unique_ID_t id = pending.back();
+            pending.pop_back();
+            for (unique_ID_t output : circuit[id].output_id_list) {
+                if (!removed[output] &&
+                    std::all_of(circuit[output].input_id_list.begin(), circuit[output].input_id_list.end(),
+                                [&removed](unique_ID_t input) { return removed[input]; })) {
+                    removed[output] = true;
+                    pending.push_back(output);
+                }
+            }
+        }
+    }
+    return node_order;
+}
+
+void VariableOrder::CollectInputs(const std::vector<unique_ID_t> &node_order) {
+    for (unique_ID_t id : node_order) {
+        if (circuit[id].gate_type == gate_type_t::Input) {
+            input_labels.emplace_back(circuit[id].label);
+        }
+    }
+}
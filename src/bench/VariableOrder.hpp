@@ -0,0 +1,119 @@
+//
+// Static variable ordering heuristics for sorted circuits
+//
+
+#pragma once
+
+#include "BenchParser.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/**
+ * \class VariableOrder
+ *
+ * \brief Computes the order in which the INPUT variables of a circuit are created.
+ *
+ *  The order is derived from the structure of the circuit before any BDD
+ *  is built. OUTPUT and FLIP FLOP nodes are the roots of the circuit.
+ *  Available heuristics:
+ *      - Circuit:    the file order. BenchParser keeps the INPUT nodes in the
+ *                    order of the INPUT lines, followed by the FLIP FLOP outputs
+ *      - DepthFirst: depth first traversal from the roots, deepest root and
+ *                    deepest fan-in first (Malik et al., Fujita et al.)
+ *      - Force:      FORCE placement of the INPUT nodes, where every root
+ *                    forms a hyperedge with the INPUT nodes of its fan-in
+ *                    cone, starting from the depth first order (Aloul et al.)
+ *      - Weight:     the INPUT with the largest weight is placed next and
+ *                    removed, where every root has weight 1 and every gate
+ *                    splits its weight among its remaining fan-ins (Minato et al.)
+ *  INPUT nodes that are not reached from any root are placed last.
+ *
+ */
+class VariableOrder {
+public:
+    enum class heuristic_t {
+        Circuit, DepthFirst, Force, Weight
+    };
+
+    /**
+     * \brief Constructor
+     * \param circuit is the topologically sorted circuit
+     * \param heuristic selects the ordering heuristic
+     *
+     */
+    VariableOrder(const sorted_circuit_t &circuit, heuristic_t heuristic);
+
+    /**
+     * \brief return the labels of all INPUT nodes, in the order their variables should be created.
+     * \param none
+     * \return const std::vector<label_t>&
+     *
+     */
+    const std::vector<label_t> &GetInputLabels() const;
+
+    /**
+     * \brief converts a heuristic name ("circuit", "dfs", "force" or "weight") to the heuristic.
+     * \param name is the name of the heuristic
+     * \param heuristic receives the heuristic
+     * \return false if the name is unknown
+     *
+     */
+    static bool ParseHeuristic(const std::string &name, heuristic_t &heuristic);
+
+    /**
+     * \brief return the name of a heuristic.
+     * \param heuristic is heuristic_t
+     * \return const char*
+     *
+     */
+    static const char *HeuristicName(heuristic_t heuristic);
+
+private:
+    static constexpr size_t FORCE_MAX_ITERATIONS = 50;
+
+    sorted_circuit_t circuit;
+    std::vector<label_t> input_labels;
+
+    /**
+     * \brief returns the OUTPUT and FLIP FLOP nodes, in circuit order.
+     * \param none
+     * \return std::vector<unique_ID_t>
+     *
+     */
+    std::vector<unique_ID_t> Roots() const;
+
+    /**
+     * \brief returns all nodes reached from the roots in depth first post order, followed by the unreached nodes.
+     * \param none
+     * \return std::vector<unique_ID_t>
+     *
+     */
+    std::vector<unique_ID_t> DepthFirstOrder() const;
+
+    /**
+     * \brief improves the placement of the INPUT nodes with the FORCE heuristic.
+     * \param node_order is the initial placement, replaced by the improved placement of the INPUT nodes
+     * \return none
+     *
+     */
+    void ForcePlacement(std::vector<unique_ID_t> &node_order) const;
+
+    /**
+     * \brief returns the INPUT nodes in the order of the weight heuristic.
+     * \param none
+     * \return std::vector<unique_ID_t>
+     *
+     */
+    std::vector<unique_ID_t> WeightOrder() const;
+
+    /**
+     * \brief appends the labels of the INPUT nodes found in node_order.
+     * \param node_order is a list of node IDs
+     * \return none
+     *
+     */
+    void CollectInputs(const std::vector<unique_ID_t> &node_order);
+};
@@ -9,33 +9,76 @@
 #include "Manager.h"
 #include "BenchParser.hpp"
 #include "CircuitToBDD.hpp"
+#include "StructuralHasher.hpp"
+#include "VariableOrder.hpp"
 #include "BenchmarkLib.h"
 
 int main(int argc, char *argv[]) {
 
     if (2 > argc) {
         std::cout << "Must specify a filename!" << std::endl;
+        std::cout << "Usage: " << argv[0] << " <file.bench|file.aag|file.aig> [--order=circuit|dfs|force|weight] [--stream]"
+                  << " [output label ...]"
+                  << std::endl;
         return -1;
     }
 
     std::string bench_file = argv[1];
 
+    /* Optionally, a variable order heuristic, streaming and the outputs whose fan-in cones are built */
+    VariableOrder::heuristic_t heuristic = VariableOrder::heuristic_t::Circuit;
+    bool stream = false;
+    std::set<label_t> selected_outputs;
+    for (int i = 2; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument.rfind("--order=", 0) == 0) {
+            if (!VariableOrder::ParseHeuristic(argument.substr(8), heuristic)) {
+                std::cout << "Unknown variable order '" << argument.substr(8) << "'!" << std::endl;
+                return -1;
+            }
+        } else if (argument == "--stream") {
+            stream = true;
+        } else {
+            selected_outputs.insert(argument);
+        }
+    }
+
     /* Parse the circuit from file and generate topological sorted circuit */
     BenchParser parsed_circuit(bench_file);
 
+    /* Merge duplicate gates and simplify the circuit before any BDD operation */
+    StructuralHasher hashed_circuit(parsed_circuit.GetSortedCircuit());
+    std::cout << "- Structural hashing eliminated " << hashed_circuit.GetNumberOfEliminatedGates() << " of "
+              << hashed_circuit.GetNumberOfGates() << " gates" << std::endl;
+
+    /* The variables are created in the order of the heuristic, before the first gate */
+    VariableOrder variable_order(hashed_circuit.GetSortedCircuit(), heuristic);
+    std::cout << "- Variable order: " << VariableOrder::HeuristicName(heuristic) << std::endl;
+
     auto BDD_manager = make_shared<ClassProject::Manager>();
     auto circuit2BDD = make_unique<CircuitToBDD>(BDD_manager);
+    circuit2BDD->SetVariableOrder(variable_order.GetInputLabels());
 
     double user_time, vm1, rss1, vm2, rss2;
 
     std::cout << "- Generating BDD from circuit...";
     process_mem_usage(vm1, rss1);
     user_time = userTime();
-    circuit2BDD->GenerateBDD(parsed_circuit.GetSortedCircuit(), bench_file);
+    if (stream) {
+        /* Each output is printed as soon as it is built, so the runtime includes the output files */
+        circuit2BDD->StreamBDD(hashed_circuit.GetSortedCircuit(), bench_file,
+                               selected_outputs.empty() ? parsed_circuit.GetListOfOutputLabels() : selected_outputs);
+    } else if (selected_outputs.empty()) {
+        circuit2BDD->GenerateBDD(hashed_circuit.GetSortedCircuit(), bench_file);
+    } else {
+        circuit2BDD->GenerateBDD(hashed_circuit.GetSortedCircuit(), bench_file, selected_outputs);
+    }
     user_time = userTime() - user_time;
     std::cout << " BDD generated successfully!" << std::endl << std::endl;
 
-    circuit2BDD->PrintBDD(parsed_circuit.GetListOfOutputLabels());
+    if (!stream) {
+        circuit2BDD->PrintBDD(selected_outputs.empty() ? parsed_circuit.GetListOfOutputLabels() : selected_outputs);
+    }
 
     std::cout << "**** Performance ****" << std::endl;
     std::cout << " Runtime: " << user_time << std::endl;
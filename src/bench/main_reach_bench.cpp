@@ -0,0 +1,111 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include "Reachability.h"
+#include "BenchParser.hpp"
+#include "CircuitToReachability.hpp"
+#include "BenchmarkLib.h"
+
+/* Number of assignments to the state bits from `level` on that satisfy the state set */
+double countStates(ClassProject::Reachability &fsm, ClassProject::BDD_ID set, size_t level,
+                   std::unordered_map<ClassProject::BDD_ID, double> &counts) {
+    const auto &states = fsm.getStates();
+
+    if (fsm.isConstant(set)) {
+        return (set == fsm.True()) ? std::ldexp(1.0, static_cast<int>(states.size() - level)) : 0.0;
+    }
+
+    /* Every state bit skipped above the top variable doubles the count */
+    size_t top_level = level;
+    while (states[top_level] != fsm.topVar(set)) {
+        top_level++;
+    }
+
+    double count;
+    auto count_it = counts.find(set);
+
+    if (count_it != counts.end()) {
+        count = count_it->second;
+    } else {
+        count = countStates(fsm, fsm.coFactorTrue(set), top_level + 1, counts) +
+                countStates(fsm, fsm.coFactorFalse(set), top_level + 1, counts);
+        counts[set] = count;
+    }
+
+    return std::ldexp(count, static_cast<int>(top_level - level));
+}
+
+int main(int argc, char *argv[]) {
+
+    if (2 > argc) {
+        std::cout << "Must specify a filename!" << std::endl;
+        std::cout << "Usage: " << argv[0] << " <file.bench|file.aag|file.aig> [bfs|chaining|approx [block size]]" << std::endl;
+        return -1;
+    }
+
+    std::string bench_file = argv[1];
+    std::string engine = (argc > 2) ? argv[2] : "bfs";
+
+    if ((engine != "bfs") && (engine != "chaining") && (engine != "approx")) {
+        std::cout << "Unknown traversal engine '" << engine << "'!" << std::endl;
+        return -1;
+    }
+
+    double build_time, reach_time, vm1, rss1, vm2, rss2;
+
+    process_mem_usage(vm1, rss1);
+
+    /* Parse the sequential circuit and build its transition functions */
+    build_time = userTime();
+    BenchParser parsed_circuit(bench_file);
+
+    std::cout << "- Building state machine from circuit...";
+    CircuitToReachability circuit2FSM(parsed_circuit, bench_file);
+    auto fsm = circuit2FSM.GetReachability();
+    build_time = userTime() - build_time;
+    std::cout << " Done!" << std::endl;
+
+    std::cout << "- Computing reachable states (" << engine << ")...";
+    if (engine == "chaining") {
+        fsm->setTraversalEngine(ClassProject::TraversalEngine::Chaining);
+    }
+    if ((engine == "approx") && (argc > 3)) {
+        fsm->setApproximationBlockSize(std::stoul(argv[3]));
+    }
+    reach_time = userTime();
+    ClassProject::BDD_ID reachable = (engine == "approx") ? fsm->approximateReachableStates()
+                                                          : fsm->reachableStates();
+    reach_time = userTime() - reach_time;
+    std::cout << " Done!" << std::endl << std::endl;
+
+    std::unordered_map<ClassProject::BDD_ID, double> counts;
+
+    std::cout << "**** Circuit ****" << std::endl;
+    std::cout << " State bits: " << fsm->getStates().size() << std::endl;
+    std::cout << " Inputs: " << fsm->getInputs().size() << std::endl;
+    std::cout << " Relation clusters: " << fsm->getTransitionClusters().size() << std::endl;
+    if (engine == "approx") {
+        std::cout << " Approximation blocks: " << fsm->getApproximationBlocks().size() << std::endl;
+    }
+    std::cout << std::endl;
+
+    std::cout << "**** Reachability ****" << std::endl;
+    std::cout << ((engine == "approx") ? " Reachable states (upper bound): " : " Reachable states: ")
+              << countStates(*fsm, reachable, 0, counts) << std::endl;
+    std::cout << " Reachable set nodes: " << fsm->nodeCount(reachable) << std::endl;
+    if (engine != "approx") {
+        /* The statistics only cover the exact traversals */
+        std::cout << " Image computations: " << fsm->getStatistics().iterations << std::endl;
+    }
+    std::cout << " Unique table size: " << fsm->uniqueTableSize() << std::endl << std::endl;
+
+    std::cout << "**** Performance ****" << std::endl;
+    std::cout << " Build runtime: " << build_time << std::endl;
+    std::cout << " Reachability runtime: " << reach_time << std::endl;
+    process_mem_usage(vm2, rss2);
+    std::cout << " VM: " << vm2 - vm1 << "; RSS: " << rss2 - rss1 << endl << endl;
+
+    return 0;
+}
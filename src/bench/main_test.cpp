@@ -0,0 +1,12 @@
+//
+// Tests of the bench front ends
+//
+
+#include "Tests.h"
+
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,8 +1,46 @@
 #include "Reachability.h"
+#include <algorithm>
 #include <stdexcept>
+#include <thread>
+#include <unordered_set>
 
 namespace ClassProject {
 
+namespace {
+
+/* Calls query(k) for k = 0..count-1, splitting the range into contiguous
+ * blocks, one per thread. */
+template <typename Query>
+void forEachQuery(std::size_t count, unsigned int threads, Query query)
+{
+    threads = std::max(1u, std::min<unsigned int>(threads, static_cast<unsigned int>(count)));
+
+    if (threads <= 1)
+    {
+        for (std::size_t k = 0; k < count; k++)
+            query(k);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    const std::size_t block = (count + threads - 1) / threads;
+
+    for (std::size_t begin = 0; begin < count; begin += block)
+    {
+        const std::size_t end = std::min(count, begin + block);
+        workers.emplace_back([begin, end, &query]()
+        {
+            for (std::size_t k = begin; k < end; k++)
+                query(k);
+        });
+    }
+
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+} // namespace
+
 Reachability::Reachability(unsigned int stateSize, unsigned int inputSize)
     : ReachabilityInterface(stateSize, inputSize)
 {
@@ -13,19 +51,26 @@ Reachability::Reachability(unsigned int stateSize, unsigned int inputSize)
     {
         const BDD_ID s = createVar(std::string("s") + std::to_string(i));
         m_stateVars.push_back(s);
+        m_stateBitOfVar.resize(s + 1);
+        m_stateBitOfVar[s] = i;
         m_transitionFunctions.push_back(s);
         m_initState.push_back(false);
 
         /* Create next state variables for the transition relation. */
         const BDD_ID s_next = createVar(std::string("s'") + std::to_string(i));
         m_nextStateVars.push_back(s_next);
-    }
+        m_nextToPresent[s_next] = s;
+        m_presentToNext[s] = s_next;
 
-    computeTransitionRelation();
-    computeInitStateCharFunction();
+        /* Keep the pair adjacent, so renaming between s and s' stays cheap. */
+        groupVariables({s, s_next});
+    }
 
     for (std::size_t i = 0; i < inputSize; i++)
         m_inputVars.push_back(createVar(std::string("x") + std::to_string(i)));
+
+    computeTransitionRelation();
+    computeInitStateCharFunction();
 }
 
 const std::vector<BDD_ID> &Reachability::getStates() const
@@ -44,48 +89,63 @@ bool Reachability::isReachable(const std::vector<bool> &stateVector)
         throw std::runtime_error(
             "isReachable() vector argument size does not match the number of input variables.");
 
-    BDD_ID reachableSet = m_initStateCharFunc;
-    BDD_ID previousReachableSet;
+    computeReachableSet();
+
+    return containsState(m_reachableSet, stateVector);
+}
 
-    while (true)
+std::vector<bool> Reachability::isReachableBatch(const std::vector<std::vector<bool>> &stateVectors,
+                                                 unsigned int threads)
+{
+    for (const std::vector<bool> &stateVector : stateVectors)
     {
-        previousReachableSet = reachableSet;
+        if (stateVector.size() != m_stateVars.size())
+            throw std::runtime_error("isReachableBatch() vector argument size does not match the "
+                                     "number of state variables.");
+    }
 
-        /* Compute image of current reachable set. */
-        BDD_ID img = and2(reachableSet, m_transitionRelation);
+    computeReachableSet();
 
-        for (std::size_t i = 0; i < m_stateVars.size(); i++)
-            img = existQuant(img, m_stateVars[i]);
+    /* std::vector<bool> packs its elements, so the threads write to bytes. */
+    std::vector<char> reachable(stateVectors.size());
+    forEachQuery(stateVectors.size(), threads, [&](std::size_t k)
+    {
+        reachable[k] = containsState(m_reachableSet, stateVectors[k]);
+    });
 
-        for (std::size_t i = 0; i < m_inputVars.size(); i++)
-            img = existQuant(img, m_inputVars[i]);
+    return std::vector<bool>(reachable.begin(), reachable.end());
+}
 
-        /* Because the characteristic function of the state set is a function of
-         * s but the image is a function of s', we must rename s' to s in the
-         * image function before adding it to the set. */
+std::vector<bool> Reachability::isReachableBatch(const std::vector<std::uint64_t> &packedStates,
+                                                 unsigned int threads)
+{
+    const std::size_t words = packedStateWords();
 
-        for (std::size_t i = 0; i < m_stateVars.size(); i++)
-            img = and2(img, xnor2(m_stateVars[i], m_nextStateVars[i]));
+    if (packedStates.size() % words != 0)
+        throw std::runtime_error("isReachableBatch() packed argument size is not a multiple of "
+                                 "packedStateWords().");
 
-        for (std::size_t i = 0; i < m_nextStateVars.size(); i++)
-            img = existQuant(img, m_nextStateVars[i]);
+    computeReachableSet();
 
-        reachableSet = or2(reachableSet, img);
+    std::vector<char> reachable(packedStates.size() / words);
+    forEachQuery(reachable.size(), threads, [&](std::size_t k)
+    {
+        reachable[k] = containsPackedState(m_reachableSet, packedStates.data() + k * words);
+    });
 
-        if (reachableSet == previousReachableSet)
-            break;
-    }
+    return std::vector<bool>(reachable.begin(), reachable.end());
+}
 
-    /* Check if argument exists in reachable set. */
-    for (std::size_t i = 0; i < m_stateVars.size(); i++)
-    {
-        if (stateVector[i])
-            reachableSet = coFactorTrue(reachableSet, m_stateVars[i]);
-        else
-            reachableSet = coFactorFalse(reachableSet, m_stateVars[i]);
-    }
+size_t Reachability::packedStateWords() const
+{
+    return (m_stateVars.size() + 63) / 64;
+}
 
-    return reachableSet; /* implicit conversion from BDD_ID to bool */
+BDD_ID Reachability::reachableStates()
+{
+    computeReachableSet();
+
+    return m_reachableSet;
 }
 
 int Reachability::stateDistance(const std::vector<bool> &stateVector)
@@ -94,69 +154,174 @@ int Reachability::stateDistance(const std::vector<bool> &stateVector)
         throw std::runtime_error(
             "stateDistance() vector argument size does not match the number of state variables.");
 
-    BDD_ID reachableSet = m_initStateCharFunc;
-    BDD_ID previousReachableSet;
-    unsigned int stepCounter = 0;
+    /* The onion rings are disjoint, so the first ring holding the state gives
+     * its shortest distance to the initial state. Once the traversal is
+     * complete, the distance is read from the distance map instead. */
+    if (!m_reachabilityValid)
+        return ringDistance(stateCharFunction(stateVector));
+
+    computeDistanceMap();
 
-    /* Check if argument is initial state. */
-    bool isInitState = true;
-    for (std::size_t i = 0; i < m_initState.size(); i++)
+    return mappedDistance(stateVector);
+}
+
+std::vector<int> Reachability::stateDistances(const std::vector<std::vector<bool>> &stateVectors,
+                                              unsigned int threads)
+{
+    for (const std::vector<bool> &stateVector : stateVectors)
     {
-        if (m_initState[i] != stateVector[i])
-        {
-            isInitState = false;
-            break;
-        }
+        if (stateVector.size() != m_stateVars.size())
+            throw std::runtime_error("stateDistances() vector argument size does not match the "
+                                     "number of state variables.");
     }
 
-    if (isInitState)
-        return 0;
+    computeDistanceMap();
 
-    /* Similar to reachability computation, except we stop when the argument
-     * state is reached. This requires checking all newly calculated images for
-     * the presence of the argument state. */
-    while (true)
+    std::vector<int> distances(stateVectors.size());
+    forEachQuery(stateVectors.size(), threads, [&](std::size_t k)
     {
-        previousReachableSet = reachableSet;
-        stepCounter++;
+        distances[k] = mappedDistance(stateVectors[k]);
+    });
+
+    return distances;
+}
 
-        /* Compute image of current reachable set. */
-        BDD_ID img = and2(reachableSet, m_transitionRelation);
+BDD_ID Reachability::distanceMap()
+{
+    computeDistanceMap();
 
-        for (std::size_t i = 0; i < m_stateVars.size(); i++)
-            img = existQuant(img, m_stateVars[i]);
+    return m_distanceMap;
+}
 
-        for (std::size_t i = 0; i < m_inputVars.size(); i++)
-            img = existQuant(img, m_inputVars[i]);
+std::vector<TraceStep> Reachability::witnessTrace(const std::vector<bool> &stateVector)
+{
+    const int distance = stateDistance(stateVector);
 
-        /* Because the characteristic function of the state set is a function of
-         * s but the image is a function of s', we must rename s' to s in the
-         * image function before adding it to the set. */
+    if (distance < 0)
+        return {};
 
-        for (std::size_t i = 0; i < m_stateVars.size(); i++)
-            img = and2(img, xnor2(m_stateVars[i], m_nextStateVars[i]));
+    std::vector<TraceStep> trace(distance + 1);
+    trace[distance].state = stateVector;
+    BDD_ID target = stateCharFunction(stateVector);
 
-        for (std::size_t i = 0; i < m_nextStateVars.size(); i++)
-            img = existQuant(img, m_nextStateVars[i]);
+    /* Every state in onion ring d + 1 has a predecessor in ring d. Pick one
+     * together with an input valuation leading from it to the current target. */
+    for (int d = distance - 1; d >= 0; d--)
+    {
+        const BDD_ID targetNext = rename(target, m_presentToNext);
+        const BDD_ID transitions = relationalProduct(and2(m_onionRings[d], targetNext),
+                                                     m_predecessorSchedule);
+        const BDD_ID step = pickOneCube(transitions);
 
-        /* Check if argument exists in new image. */
-        BDD_ID existCheckSet = img;
-        for (std::size_t i = 0; i < m_stateVars.size(); i++)
-        {
-            if (stateVector[i])
-                existCheckSet = coFactorTrue(existCheckSet, m_stateVars[i]);
-            else
-                existCheckSet = coFactorFalse(existCheckSet, m_stateVars[i]);
-        }
+        trace[d].state = cubeAssignment(step, m_stateVars);
+        trace[d].inputs = cubeAssignment(step, m_inputVars);
+        target = stateCharFunction(trace[d].state);
+    }
+
+    return trace;
+}
+
+InvariantResult Reachability::checkInvariant(BDD_ID badStates)
+{
+    if (badStates >= this->unique_table_vector.size())
+        throw std::runtime_error("checkInvariant() argument is a non-existent BDD_ID.");
+
+    InvariantResult result;
+    result.depth = ringDistance(badStates);
+
+    if (result.depth < 0)
+        return result;
+
+    result.holds = false;
+
+    const BDD_ID nearestBad = and2(m_onionRings[result.depth], badStates);
+    result.trace = witnessTrace(cubeAssignment(pickOneCube(nearestBad), m_stateVars));
+
+    return result;
+}
+
+InvariantResult Reachability::checkInvariantApproximate(BDD_ID badStates)
+{
+    if (badStates >= this->unique_table_vector.size())
+        throw std::runtime_error("checkInvariantApproximate() argument is a non-existent BDD_ID.");
+
+    InvariantResult result;
+
+    if (and2(approximateReachableStates(), badStates) != FALSE_ID)
+    {
+        /* The hit is a real violation if the set is exact: the reachable set
+         * itself, or a single block that covers all state bits. */
+        result.holds = false;
+        result.conclusive = m_reachableSetValid ||
+                            ((m_approximationBlocks.size() == 1) &&
+                             (m_approximationBlocks.front().size() == m_stateVars.size()));
+    }
+
+    return result;
+}
 
-        if (existCheckSet)
-            return stepCounter;
+size_t Reachability::reorderVariables()
+{
+    /* Everything that is kept across calls, so it is measured in the new
+     * order. Sets not computed yet hold no valid BDD_ID. */
+    std::vector<BDD_ID> roots = m_transitionFunctions;
+    roots.insert(roots.end(), m_bitRelations.begin(), m_bitRelations.end());
+    roots.insert(roots.end(), m_transitionClusters.begin(), m_transitionClusters.end());
+    roots.insert(roots.end(), m_eventConstraints.begin(), m_eventConstraints.end());
+    roots.push_back(m_initStateCharFunc);
 
-        reachableSet = or2(reachableSet, img);
+    if (!m_onionRings.empty())
+    {
+        roots.insert(roots.end(), m_onionRings.begin(), m_onionRings.end());
+        roots.push_back(m_traversedSet);
+    }
 
-        if (reachableSet == previousReachableSet)
-            return -1;
+    if (m_reachableSetValid)
+        roots.push_back(m_reachableSet);
+
+    if (m_distanceMapValid)
+        roots.push_back(m_distanceMap);
+
+    if (m_approximationValid)
+    {
+        roots.insert(roots.end(), m_blockReachableSets.begin(), m_blockReachableSets.end());
+        roots.push_back(m_approximateSet);
     }
+
+    return reorder(roots);
+}
+
+void Reachability::setApproximationBlockSize(size_t maxBits)
+{
+    if (maxBits == 0)
+        throw std::runtime_error("setApproximationBlockSize() argument is 0.");
+
+    m_approximationBlockSize = maxBits;
+    m_approximationBlocks.clear();
+    m_approximationValid = false;
+}
+
+size_t Reachability::getApproximationBlockSize() const
+{
+    return m_approximationBlockSize;
+}
+
+const std::vector<std::vector<size_t>> &Reachability::getApproximationBlocks()
+{
+    computeApproximationBlocks();
+
+    return m_approximationBlocks;
+}
+
+BDD_ID Reachability::approximateReachableStates()
+{
+    /* The exact result is the best approximation, if it is known already. */
+    if (m_reachableSetValid)
+        return m_reachableSet;
+
+    computeApproximation();
+
+    return m_approximateSet;
 }
 
 void Reachability::setTransitionFunctions(const std::vector<BDD_ID> &transitionFunctions)
@@ -174,6 +339,70 @@ void Reachability::setTransitionFunctions(const std::vector<BDD_ID> &transitionF
 
     m_transitionFunctions = transitionFunctions;
     computeTransitionRelation();
+    invalidateReachability();
+}
+
+void Reachability::updateTransitionFunction(size_t bit, BDD_ID transitionFunction)
+{
+    updateTransitionFunctions({{bit, transitionFunction}});
+}
+
+void Reachability::updateTransitionFunctions(const std::unordered_map<size_t, BDD_ID> &changes)
+{
+    for (const auto &change : changes)
+    {
+        if (change.first >= m_stateVars.size())
+            throw std::runtime_error("updateTransitionFunctions() argument contains a non-existent state bit.");
+
+        if (change.second >= this->unique_table_vector.size())
+            throw std::runtime_error("updateTransitionFunctions() argument contains a non-existent BDD_ID.");
+    }
+
+    /* Collect the states and inputs on which some function changes, and
+     * rebuild only the clusters holding a changed bit. */
+    BDD_ID differences = FALSE_ID;
+    std::unordered_set<size_t> changedClusters;
+
+    for (const auto &change : changes)
+    {
+        const size_t bit = change.first;
+
+        if (change.second == m_transitionFunctions[bit])
+            continue;
+
+        differences = or2(differences, xor2(m_transitionFunctions[bit], change.second));
+        m_transitionFunctions[bit] = change.second;
+        m_bitRelations[bit] = xnor2(m_nextStateVars[bit], change.second);
+        changedClusters.insert(m_clusterOfBit[bit]);
+    }
+
+    if (differences == FALSE_ID)
+        return;
+
+    for (size_t c : changedClusters)
+    {
+        BDD_ID cluster = TRUE_ID;
+        for (size_t bit : m_clusterBits[c])
+            cluster = and2(cluster, m_bitRelations[bit]);
+
+        m_transitionClusters[c] = cluster;
+        m_clusterSupports[c] = support(cluster);
+    }
+
+    computeSchedules();
+    m_eventConstraints.clear();
+    m_approximationBlocks.clear();
+    m_approximationValid = false;
+
+    /* Results stay valid if the old and new functions agree on every state
+     * they were computed from. */
+    if (m_reachableSetValid && (and2(m_reachableSet, differences) == FALSE_ID))
+        return;
+
+    m_reachableSetValid = false;
+
+    if (m_onionRings.empty() || (and2(m_traversedSet, differences) != FALSE_ID))
+        invalidateReachability();
 }
 
 void Reachability::setInitState(const std::vector<bool> &stateVector)
@@ -184,35 +413,719 @@ void Reachability::setInitState(const std::vector<bool> &stateVector)
 
     m_initState = stateVector;
     computeInitStateCharFunction();
+    invalidateReachability();
 }
 
 void Reachability::computeTransitionRelation()
 {
-    m_transitionRelation = TRUE_ID;
-
-    /* tau(s,x,r) = Pi_i_from_0_to_nr_of_state_bits( r[i] XNOR delta(s[i],x[i]) ) */
+    /* tau(s,x,r) = Pi_i_from_0_to_nr_of_state_bits( r[i] XNOR delta(s[i],x[i]) )
+     * The product is never built as a whole, it is kept as a list of clusters
+     * that the image computation conjoins one at a time. */
+    m_bitRelations.clear();
     for (std::size_t i = 0; i < m_transitionFunctions.size(); i++)
+        m_bitRelations.push_back(xnor2(m_nextStateVars[i], m_transitionFunctions[i]));
+
+    m_eventConstraints.clear();
+    m_transitionClusters.clear();
+    m_clusterBits.clear();
+    m_clusterOfBit.assign(m_bitRelations.size(), 0);
+    BDD_ID cluster = TRUE_ID;
+    std::vector<size_t> clusterBits;
+
+    for (size_t bit : orderBitRelations())
+    {
+        const BDD_ID candidate = and2(cluster, m_bitRelations[bit]);
+
+        if ((cluster != TRUE_ID) && (nodeCount(candidate) > m_clusterThreshold))
+        {
+            m_transitionClusters.push_back(cluster);
+            m_clusterBits.push_back(clusterBits);
+            cluster = m_bitRelations[bit];
+            clusterBits.clear();
+        }
+        else
+        {
+            cluster = candidate;
+        }
+
+        m_clusterOfBit[bit] = m_transitionClusters.size();
+        clusterBits.push_back(bit);
+    }
+    m_transitionClusters.push_back(cluster);
+    m_clusterBits.push_back(clusterBits);
+
+    m_clusterSupports.clear();
+    for (BDD_ID c : m_transitionClusters)
+        m_clusterSupports.push_back(support(c));
+
+    computeSchedules();
+}
+
+void Reachability::computeSchedules()
+{
+    std::vector<BDD_ID> presentAndInputs = m_stateVars;
+    presentAndInputs.insert(presentAndInputs.end(), m_inputVars.begin(), m_inputVars.end());
+    m_imageSchedule = quantificationSchedule(presentAndInputs);
+
+    std::vector<BDD_ID> nextAndInputs = m_nextStateVars;
+    nextAndInputs.insert(nextAndInputs.end(), m_inputVars.begin(), m_inputVars.end());
+    m_preImageSchedule = quantificationSchedule(nextAndInputs);
+    m_predecessorSchedule = quantificationSchedule(m_nextStateVars);
+}
+
+std::vector<size_t> Reachability::orderBitRelations()
+{
+    /* Greedy ordering in the spirit of IWLS95: repeatedly pick the relation
+     * whose quantifiable variables occur in the fewest other remaining
+     * relations, relative to the number of variables it introduces. */
+    std::unordered_set<BDD_ID> quantifiable(m_stateVars.begin(), m_stateVars.end());
+    quantifiable.insert(m_inputVars.begin(), m_inputVars.end());
+
+    std::vector<std::vector<BDD_ID>> quantifyVars(m_bitRelations.size());
+    std::unordered_map<BDD_ID, size_t> occurrences;
+
+    for (std::size_t i = 0; i < m_bitRelations.size(); i++)
+    {
+        for (BDD_ID v : support(m_transitionFunctions[i]))
+        {
+            if (quantifiable.count(v))
+            {
+                quantifyVars[i].push_back(v);
+                occurrences[v]++;
+            }
+        }
+    }
+
+    std::vector<size_t> order;
+    std::vector<bool> scheduled(m_bitRelations.size(), false);
+
+    while (order.size() < m_bitRelations.size())
     {
-        const BDD_ID buf = xnor2(m_nextStateVars[i], m_transitionFunctions[i]);
-        m_transitionRelation = and2(m_transitionRelation, buf);
+        size_t best = 0;
+        double bestScore = -1.0;
+
+        for (std::size_t i = 0; i < m_bitRelations.size(); i++)
+        {
+            if (scheduled[i])
+                continue;
+
+            size_t lastUse = 0;
+            for (BDD_ID v : quantifyVars[i])
+                lastUse += (occurrences[v] == 1);
+
+            const double score = quantifyVars[i].empty()
+                                     ? 1.0
+                                     : static_cast<double>(lastUse) / quantifyVars[i].size();
+
+            if ((score > bestScore) ||
+                ((score == bestScore) && (quantifyVars[i].size() < quantifyVars[best].size())))
+            {
+                best = i;
+                bestScore = score;
+            }
+        }
+
+        scheduled[best] = true;
+        order.push_back(best);
+        for (BDD_ID v : quantifyVars[best])
+            occurrences[v]--;
     }
+
+    return order;
+}
+
+std::vector<BDD_ID> Reachability::quantificationSchedule(const std::vector<BDD_ID> &quantifyVars)
+{
+    /* Each variable is quantified right after the last cluster depending on
+     * it. Variables no cluster depends on are quantified before the first. */
+    std::vector<std::vector<BDD_ID>> buckets(m_transitionClusters.size() + 1);
+    std::unordered_map<BDD_ID, size_t> lastCluster;
+
+    for (std::size_t j = 0; j < m_clusterSupports.size(); j++)
+    {
+        for (BDD_ID v : m_clusterSupports[j])
+            lastCluster[v] = j + 1;
+    }
+
+    for (BDD_ID v : quantifyVars)
+    {
+        auto it = lastCluster.find(v);
+        buckets[(it != lastCluster.end()) ? it->second : 0].push_back(v);
+    }
+
+    std::vector<BDD_ID> schedule;
+    for (const auto &bucket : buckets)
+        schedule.push_back(makeCube(bucket));
+
+    return schedule;
 }
 
 void Reachability::computeInitStateCharFunction()
 {
-    m_initStateCharFunc = TRUE_ID;
+    m_initStateCharFunc = stateCharFunction(m_initState);
+}
+
+BDD_ID Reachability::stateCharFunction(const std::vector<bool> &stateVector)
+{
+    if (stateVector.size() != m_stateVars.size())
+        throw std::runtime_error("stateCharFunction() vector argument size does not match the "
+                                 "number of state variables.");
+
+    BDD_ID charFunc = TRUE_ID;
 
-    for (std::size_t i = 0; i < m_initState.size(); i++)
+    for (std::size_t i = 0; i < stateVector.size(); i++)
     {
-        /* m_initState values are implicitly converted to BDD_ID. */
-        const BDD_ID buf = xnor2(m_stateVars[i], m_initState[i]);
-        m_initStateCharFunc = and2(m_initStateCharFunc, buf);
+        /* stateVector values are implicitly converted to BDD_ID. */
+        const BDD_ID buf = xnor2(m_stateVars[i], stateVector[i]);
+        charFunc = and2(charFunc, buf);
     }
+
+    return charFunc;
+}
+
+void Reachability::setImageMode(ImageMode mode)
+{
+    m_imageMode = mode;
+}
+
+ImageMode Reachability::getImageMode() const
+{
+    return m_imageMode;
+}
+
+const ReachabilityStatistics &Reachability::getStatistics() const
+{
+    return m_statistics;
+}
+
+void Reachability::setTraversalEngine(TraversalEngine engine)
+{
+    m_traversalEngine = engine;
+}
+
+TraversalEngine Reachability::getTraversalEngine() const
+{
+    return m_traversalEngine;
+}
+
+void Reachability::setClusterThreshold(size_t maxNodes)
+{
+    m_clusterThreshold = maxNodes;
+    computeTransitionRelation();
+}
+
+size_t Reachability::getClusterThreshold() const
+{
+    return m_clusterThreshold;
 }
 
-BDD_ID Reachability::existQuant(BDD_ID f, BDD_ID v)
+const std::vector<BDD_ID> &Reachability::getTransitionClusters() const
 {
-    return or2(coFactorTrue(f, v), coFactorFalse(f, v));
+    return m_transitionClusters;
+}
+
+void Reachability::computeReachability()
+{
+    advanceTraversal(FALSE_ID);
+}
+
+void Reachability::advanceTraversal(BDD_ID stopSet)
+{
+    if (m_reachabilityValid)
+        return;
+
+    if (m_onionRings.empty())
+    {
+        m_onionRings.push_back(m_initStateCharFunc);
+        m_traversedSet = m_initStateCharFunc;
+        m_statistics = ReachabilityStatistics();
+    }
+
+    /* Breadth-first traversal, storing the newly reached states of every step
+     * as a separate onion ring until no new states are found or the newest
+     * ring meets the stop set. States reached before the previous step only
+     * map into the reached set again, so it suffices to image the frontier. */
+    while (and2(m_onionRings.back(), stopSet) == FALSE_ID)
+    {
+        const BDD_ID frontier = m_onionRings.back();
+        BDD_ID operand = frontier;
+
+        switch (m_imageMode)
+        {
+            case ImageMode::ReachedSet:
+                operand = m_traversedSet;
+                break;
+            case ImageMode::Frontier:
+                break;
+            case ImageMode::FrontierRestrict:
+                /* Any set between frontier and reached set will do. */
+                operand = restrict(frontier, or2(frontier, neg(m_traversedSet)));
+                break;
+        }
+
+        m_statistics.iterations++;
+        m_statistics.operandSizes.push_back(nodeCount(operand));
+        m_statistics.reachedSizes.push_back(nodeCount(m_traversedSet));
+
+        const BDD_ID newStates = and2(image(operand), neg(m_traversedSet));
+
+        if (newStates == FALSE_ID)
+        {
+            m_reachableSet = m_traversedSet;
+            m_reachabilityValid = true;
+            m_reachableSetValid = true;
+            return;
+        }
+
+        m_onionRings.push_back(newStates);
+        m_traversedSet = or2(m_traversedSet, newStates);
+    }
+}
+
+void Reachability::computeDistanceMap()
+{
+    if (m_distanceMapValid)
+        return;
+
+    computeReachability();
+
+    /* Built from the outermost ring inwards, each ring selecting its
+     * distance and leaving the other states to the rings outside of it. */
+    m_distanceMap = addConst(-1);
+
+    for (std::size_t distance = m_onionRings.size(); distance-- > 0;)
+        m_distanceMap = ite(m_onionRings[distance], addConst(distance), m_distanceMap);
+
+    m_distanceMapValid = true;
+}
+
+int Reachability::mappedDistance(const std::vector<bool> &stateVector)
+{
+    const BDD_ID terminal = followPath(m_distanceMap, [&](BDD_ID var)
+    {
+        return static_cast<bool>(stateVector[m_stateBitOfVar[var]]);
+    });
+
+    return static_cast<int>(addValue(terminal));
+}
+
+int Reachability::ringDistance(BDD_ID targetSet)
+{
+    /* Scan the rings computed so far and only extend the traversal when none
+     * of them meets the target. */
+    for (std::size_t distance = 0;; distance++)
+    {
+        if (distance == m_onionRings.size())
+        {
+            if (m_reachabilityValid)
+                return -1;
+
+            advanceTraversal(targetSet);
+
+            if (distance == m_onionRings.size())
+                return -1;
+        }
+
+        if (and2(m_onionRings[distance], targetSet) != FALSE_ID)
+            return static_cast<int>(distance);
+    }
+}
+
+void Reachability::computeReachableSet()
+{
+    if (m_reachableSetValid)
+        return;
+
+    if (m_traversalEngine == TraversalEngine::BreadthFirst)
+    {
+        computeReachability();
+        return;
+    }
+
+    computeEvents();
+    m_statistics = ReachabilityStatistics();
+    m_reachableSet = m_initStateCharFunc;
+
+    /* Chaining: fire the events from the last state bit index down to the
+     * first, each one until it adds no more states. New states found by an
+     * event may enable events of later bits again, so sweep until a whole
+     * pass over all events finds nothing new. */
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+
+        for (std::size_t k = m_stateVars.size(); k-- > 0;)
+        {
+            BDD_ID frontier = m_reachableSet;
+
+            while (true)
+            {
+                m_statistics.iterations++;
+                m_statistics.operandSizes.push_back(nodeCount(frontier));
+                m_statistics.reachedSizes.push_back(nodeCount(m_reachableSet));
+
+                const BDD_ID newStates = and2(eventImage(k, frontier), neg(m_reachableSet));
+
+                if (newStates == FALSE_ID)
+                    break;
+
+                m_reachableSet = or2(m_reachableSet, newStates);
+                frontier = newStates;
+                changed = true;
+            }
+        }
+    }
+
+    m_reachableSetValid = true;
+}
+
+void Reachability::computeEvents()
+{
+    if (!m_eventConstraints.empty())
+        return;
+
+    /* The transitions that change some state bit are partitioned by the
+     * first changing bit k. Staying in a state does not add reachable
+     * states, so the events together are as good as the whole relation. */
+    BDD_ID unchangedBefore = TRUE_ID;
+
+    for (std::size_t k = 0; k < m_stateVars.size(); k++)
+    {
+        const BDD_ID changes = xor2(m_transitionFunctions[k], m_stateVars[k]);
+        m_eventConstraints.push_back(and2(unchangedBefore, changes));
+        unchangedBefore = and2(unchangedBefore, neg(changes));
+    }
+
+    /* Event k quantifies bits k and after and the inputs, each right after
+     * the last bit relation depending on it. Bits before k are kept. */
+    std::vector<std::vector<BDD_ID>> relationSupports;
+    for (BDD_ID relation : m_bitRelations)
+        relationSupports.push_back(support(relation));
+
+    m_eventSchedules.clear();
+    for (std::size_t k = 0; k < m_stateVars.size(); k++)
+    {
+        std::vector<std::vector<BDD_ID>> buckets(m_stateVars.size() - k + 1);
+        std::unordered_map<BDD_ID, size_t> lastRelation;
+
+        for (std::size_t i = k; i < m_stateVars.size(); i++)
+        {
+            for (BDD_ID v : relationSupports[i])
+                lastRelation[v] = i - k + 1;
+        }
+
+        std::vector<BDD_ID> quantifyVars(m_stateVars.begin() + k, m_stateVars.end());
+        quantifyVars.insert(quantifyVars.end(), m_inputVars.begin(), m_inputVars.end());
+
+        for (BDD_ID v : quantifyVars)
+        {
+            auto it = lastRelation.find(v);
+            buckets[(it != lastRelation.end()) ? it->second : 0].push_back(v);
+        }
+
+        std::vector<BDD_ID> schedule;
+        for (const auto &bucket : buckets)
+            schedule.push_back(makeCube(bucket));
+        m_eventSchedules.push_back(schedule);
+    }
+}
+
+void Reachability::computeApproximationBlocks()
+{
+    if (!m_approximationBlocks.empty())
+        return;
+
+    const std::size_t n = m_stateVars.size();
+    std::vector<std::vector<size_t>> fanin(n);
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        for (BDD_ID v : support(m_transitionFunctions[i]))
+        {
+            if ((v < m_stateBitOfVar.size()) && (m_stateVars[m_stateBitOfVar[v]] == v))
+                fanin[i].push_back(m_stateBitOfVar[v]);
+        }
+    }
+
+    /* Grow a block from each uncovered bit through its fanin, nearest
+     * dependencies first. */
+    std::vector<bool> covered(n, false);
+    std::vector<std::vector<size_t>> blocks;
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        if (covered[i])
+            continue;
+
+        std::vector<size_t> block;
+        std::vector<bool> inBlock(n, false);
+        std::vector<size_t> pending = {i};
+
+        for (std::size_t head = 0; (head < pending.size()) && (block.size() < m_approximationBlockSize); head++)
+        {
+            const size_t bit = pending[head];
+
+            if (inBlock[bit])
+                continue;
+
+            inBlock[bit] = true;
+            covered[bit] = true;
+            block.push_back(bit);
+            pending.insert(pending.end(), fanin[bit].begin(), fanin[bit].end());
+        }
+
+        std::sort(block.begin(), block.end());
+        blocks.push_back(block);
+    }
+
+    for (std::size_t b = 0; b < blocks.size(); b++)
+    {
+        bool contained = false;
+
+        for (std::size_t c = 0; (c < blocks.size()) && !contained; c++)
+        {
+            contained = (c != b) && (blocks[c].size() > blocks[b].size()) &&
+                        std::includes(blocks[c].begin(), blocks[c].end(), blocks[b].begin(), blocks[b].end());
+        }
+
+        if (!contained)
+            m_approximationBlocks.push_back(blocks[b]);
+    }
+}
+
+void Reachability::computeApproximation()
+{
+    if (m_approximationValid)
+        return;
+
+    computeApproximationBlocks();
+
+    const std::size_t blockCount = m_approximationBlocks.size();
+    std::vector<BDD_ID> presentAndInputs = m_stateVars;
+    presentAndInputs.insert(presentAndInputs.end(), m_inputVars.begin(), m_inputVars.end());
+    const BDD_ID presentAndInputsCube = makeCube(presentAndInputs);
+
+    /* Each block starts from the projection of the initial state and is only
+     * constrained by the blocks sharing a bit with the support of its
+     * transition functions. */
+    std::vector<std::vector<size_t>> constrainingBlocks(blockCount);
+    m_blockReachableSets.clear();
+
+    for (std::size_t b = 0; b < blockCount; b++)
+    {
+        std::vector<BDD_ID> outsideVars;
+        std::vector<bool> inBlock(m_stateVars.size(), false);
+        std::unordered_set<size_t> faninBits;
+
+        for (size_t bit : m_approximationBlocks[b])
+        {
+            inBlock[bit] = true;
+
+            for (BDD_ID v : support(m_transitionFunctions[bit]))
+            {
+                if ((v < m_stateBitOfVar.size()) && (m_stateVars[m_stateBitOfVar[v]] == v))
+                    faninBits.insert(m_stateBitOfVar[v]);
+            }
+        }
+
+        for (std::size_t i = 0; i < m_stateVars.size(); i++)
+        {
+            if (!inBlock[i])
+                outsideVars.push_back(m_stateVars[i]);
+        }
+
+        m_blockReachableSets.push_back(exists(m_initStateCharFunc, makeCube(outsideVars)));
+
+        for (std::size_t c = 0; c < blockCount; c++)
+        {
+            if (c == b)
+                continue;
+
+            for (size_t bit : m_approximationBlocks[c])
+            {
+                if (!inBlock[bit] && faninBits.count(bit))
+                {
+                    constrainingBlocks[b].push_back(c);
+                    break;
+                }
+            }
+        }
+    }
+
+    /* Reachable sets only grow, so sweeping over the blocks until none of
+     * them changes reaches the least common fixpoint. */
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+
+        for (std::size_t b = 0; b < blockCount; b++)
+        {
+            const std::vector<size_t> &block = m_approximationBlocks[b];
+            BDD_ID operand = m_blockReachableSets[b];
+
+            for (size_t c : constrainingBlocks[b])
+                operand = and2(operand, m_blockReachableSets[c]);
+
+            for (std::size_t k = 0; k + 1 < block.size(); k++)
+                operand = and2(operand, m_bitRelations[block[k]]);
+
+            const BDD_ID next = andExists(operand, m_bitRelations[block.back()], presentAndInputsCube);
+            const BDD_ID reached = or2(m_blockReachableSets[b], rename(next, m_nextToPresent));
+
+            if (reached != m_blockReachableSets[b])
+            {
+                m_blockReachableSets[b] = reached;
+                changed = true;
+            }
+        }
+    }
+
+    m_approximateSet = TRUE_ID;
+    for (BDD_ID blockSet : m_blockReachableSets)
+        m_approximateSet = and2(m_approximateSet, blockSet);
+
+    m_approximationValid = true;
+}
+
+void Reachability::invalidateReachability()
+{
+    m_reachableSetValid = false;
+    m_reachabilityValid = false;
+    m_onionRings.clear();
+    m_distanceMapValid = false;
+    m_approximationBlocks.clear();
+    m_approximationValid = false;
+}
+
+BDD_ID Reachability::image(BDD_ID stateSet)
+{
+    /* Because the characteristic function of the state set is a function of
+     * s but the image is a function of s', we must rename s' to s in the
+     * image function before adding it to the set. */
+    return rename(relationalProduct(stateSet, m_imageSchedule), m_nextToPresent);
+}
+
+BDD_ID Reachability::preImage(BDD_ID stateSet)
+{
+    /* The target states are successors, so they are expressed over s' and
+     * the relation is quantified over s' and the inputs instead. */
+    return relationalProduct(rename(stateSet, m_presentToNext), m_preImageSchedule);
+}
+
+BDD_ID Reachability::backwardReachable(BDD_ID targetSet)
+{
+    if (targetSet >= this->unique_table_vector.size())
+        throw std::runtime_error("backwardReachable() argument is a non-existent BDD_ID.");
+
+    BDD_ID reached = targetSet;
+    BDD_ID frontier = targetSet;
+
+    while (frontier != FALSE_ID)
+    {
+        frontier = and2(preImage(frontier), neg(reached));
+        reached = or2(reached, frontier);
+    }
+
+    return reached;
+}
+
+bool Reachability::canReach(BDD_ID targetSet)
+{
+    if (targetSet >= this->unique_table_vector.size())
+        throw std::runtime_error("canReach() argument is a non-existent BDD_ID.");
+
+    if (m_reachableSetValid)
+        return and2(m_reachableSet, targetSet) != FALSE_ID;
+
+    BDD_ID forwardReached = m_initStateCharFunc;
+    BDD_ID backwardReached = targetSet;
+    BDD_ID forwardFrontier = forwardReached;
+    BDD_ID backwardFrontier = backwardReached;
+
+    /* The searches meet iff a target state is reachable. If one of them runs
+     * out of new states first, its reached set is complete and disjoint from
+     * the other one, so no target state is reachable. */
+    while (and2(forwardReached, backwardReached) == FALSE_ID)
+    {
+        if ((forwardFrontier == FALSE_ID) || (backwardFrontier == FALSE_ID))
+            return false;
+
+        if (nodeCount(forwardFrontier) <= nodeCount(backwardFrontier))
+        {
+            forwardFrontier = and2(image(forwardFrontier), neg(forwardReached));
+            forwardReached = or2(forwardReached, forwardFrontier);
+        }
+        else
+        {
+            backwardFrontier = and2(preImage(backwardFrontier), neg(backwardReached));
+            backwardReached = or2(backwardReached, backwardFrontier);
+        }
+    }
+
+    return true;
+}
+
+BDD_ID Reachability::eventImage(size_t event, BDD_ID stateSet)
+{
+    const std::vector<BDD_ID> &schedule = m_eventSchedules[event];
+    BDD_ID product = andExists(stateSet, m_eventConstraints[event], schedule[0]);
+
+    for (std::size_t i = event; i < m_bitRelations.size(); i++)
+        product = andExists(product, m_bitRelations[i], schedule[i - event + 1]);
+
+    return rename(product, m_nextToPresent);
+}
+
+BDD_ID Reachability::relationalProduct(BDD_ID set, const std::vector<BDD_ID> &schedule)
+{
+    /* Conjoin the clusters one by one, quantifying each variable as soon as
+     * no later cluster depends on it. */
+    BDD_ID product = exists(set, schedule[0]);
+
+    for (std::size_t j = 0; j < m_transitionClusters.size(); j++)
+        product = andExists(product, m_transitionClusters[j], schedule[j + 1]);
+
+    return product;
+}
+
+bool Reachability::containsState(BDD_ID stateSet, const std::vector<bool> &stateVector)
+{
+    /* Walk a single path from the root. State sets only depend on the state
+     * variables, so no other variables are met on the way. */
+    return evaluateWith(stateSet, [&](BDD_ID var)
+    {
+        return static_cast<bool>(stateVector[m_stateBitOfVar[var]]);
+    });
+}
+
+bool Reachability::containsPackedState(BDD_ID stateSet, const std::uint64_t *packedState)
+{
+    return evaluateWith(stateSet, [&](BDD_ID var)
+    {
+        const std::size_t bit = m_stateBitOfVar[var];
+        return ((packedState[bit / 64] >> (bit % 64)) & 1u) != 0;
+    });
+}
+
+std::vector<bool> Reachability::cubeAssignment(BDD_ID cube, const std::vector<BDD_ID> &vars)
+{
+    /* Variables not in the cube are don't cares and default to false. */
+    std::unordered_map<BDD_ID, bool> literals;
+
+    while (!isConstant(cube))
+    {
+        const BDD_ID high = coFactorTrue(cube);
+        literals[topVar(cube)] = (high != FALSE_ID);
+        cube = (high != FALSE_ID) ? high : coFactorFalse(cube);
+    }
+
+    std::vector<bool> values;
+    for (BDD_ID v : vars)
+        values.push_back(literals.count(v) && literals[v]);
+
+    return values;
 }
 
 } // namespace ClassProject
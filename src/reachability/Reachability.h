@@ -2,9 +2,60 @@
 #define VDSPROJECT_REACHABILITY_H
 
 #include "ReachabilityInterface.h"
+#include <cstdint>
+#include <unordered_map>
 
 namespace ClassProject {
 
+/**
+ * Selects the set whose image is computed in each step of the forward traversal.
+ */
+enum class ImageMode
+{
+    ReachedSet, ///< image of all states reached so far
+    Frontier, ///< image of the states found in the previous step only
+    FrontierRestrict ///< frontier minimized with restrict() against the reached set
+};
+
+/**
+ * Selects the algorithm computing the reachable state set.
+ */
+enum class TraversalEngine
+{
+    BreadthFirst, ///< one image under the whole transition relation per step
+    Chaining ///< events fired from the last state bit to the first, each to a local fixpoint
+};
+
+/**
+ * Statistics of the last forward traversal.
+ */
+struct ReachabilityStatistics
+{
+    unsigned int iterations = 0; ///< number of image computations
+    std::vector<size_t> operandSizes; ///< BDD size of the image operand per iteration
+    std::vector<size_t> reachedSizes; ///< BDD size of the reached set per iteration
+};
+
+/**
+ * One step of a witness trace: a state and the input applied in it.
+ */
+struct TraceStep
+{
+    std::vector<bool> state; ///< assignment of each state bit
+    std::vector<bool> inputs; ///< assignment of each input bit, empty for the last step
+};
+
+/**
+ * Outcome of checkInvariant().
+ */
+struct InvariantResult
+{
+    bool holds = true; ///< true, if no bad state is reachable
+    int depth = -1; ///< distance of the nearest reachable bad state, -1 if the invariant holds
+    std::vector<TraceStep> trace; ///< shortest trace into a bad state, empty if the invariant holds
+    bool conclusive = true; ///< false if an over-approximation failed to exclude the bad states
+};
+
 class Reachability : public ReachabilityInterface
 {
 public:
@@ -22,19 +73,332 @@ public:
 
     void setInitState(const std::vector<bool> &) override;
 
+    /**
+     * Replaces the transition function of a single state bit. Only the
+     * cluster of the transition relation holding this bit is rebuilt, keeping
+     * the cluster order, so a cluster may grow beyond the threshold until the
+     * next call to setTransitionFunctions(). Cached reachability results are
+     * kept if the old and new function agree on all states they cover.
+     *
+     * @param bit index of the state bit
+     * @param transitionFunction new transition function of the bit
+     * @throws std::runtime_error if the bit or the BDD_ID does not exist
+     */
+    void updateTransitionFunction(size_t bit, BDD_ID transitionFunction);
+
+    /**
+     * Same as above for several bits at once.
+     *
+     * @param changes new transition function per state bit index
+     * @throws std::runtime_error if a bit or a BDD_ID does not exist
+     */
+    void updateTransitionFunctions(const std::unordered_map<size_t, BDD_ID> &changes);
+
+    /**
+     * Checks many states against the reachable state set, which is computed
+     * once. Each query is a single path walk through the BDD, which does not
+     * modify the manager, so the queries can be split across threads.
+     *
+     * @param stateVectors provide the assignment for each state bit
+     * @param threads number of threads answering the queries
+     * @returns one entry per state vector, true if the state is reachable
+     * @throws std::runtime_error if the size of a vector does not match with number of state bits
+     */
+    std::vector<bool> isReachableBatch(const std::vector<std::vector<bool>> &stateVectors,
+                                       unsigned int threads = 1);
+
+    /**
+     * Same as above, with every state packed into packedStateWords() words.
+     * State bit i is bit i % 64 of word i / 64.
+     *
+     * @param packedStates concatenation of the packed states
+     * @param threads number of threads answering the queries
+     * @returns one entry per packed state, true if the state is reachable
+     * @throws std::runtime_error if the size is not a multiple of packedStateWords()
+     */
+    std::vector<bool> isReachableBatch(const std::vector<std::uint64_t> &packedStates,
+                                       unsigned int threads = 1);
+
+    /**
+     * @returns number of 64-bit words holding one packed state
+     */
+    size_t packedStateWords() const;
+
+    /**
+     * Returns the distance of many states, read from distanceMap() with one
+     * path walk per state. The walks can be split across threads.
+     *
+     * @param stateVectors provide the assignment for each state bit
+     * @param threads number of threads answering the queries
+     * @returns stateDistance() of each state vector
+     * @throws std::runtime_error if the size of a vector does not match with number of state bits
+     */
+    std::vector<int> stateDistances(const std::vector<std::vector<bool>> &stateVectors,
+                                    unsigned int threads = 1);
+
+    /**
+     * Builds an ADD over the state variables mapping every state to its
+     * distance from the initial state, or to -1 if it is unreachable. Once
+     * built, stateDistance() answers from it.
+     *
+     * @returns ADD with the distances as terminal values, see Manager::addValue()
+     */
+    BDD_ID distanceMap();
+
+    /**
+     * Returns the characteristic function of the reachable state set. Its
+     * minterms over getStates() can be listed with minterms().
+     * The fixpoint is computed once and reused until the transition functions
+     * or the initial state change.
+     *
+     * @returns BDD of all states reachable from the initial state
+     */
+    BDD_ID reachableStates();
+
+    /**
+     * Selects the set imaged in each traversal step. All modes yield the same
+     * reachable states and distances, only the cost of each step differs.
+     *
+     * @param mode image operand selection, defaults to ImageMode::Frontier
+     */
+    void setImageMode(ImageMode mode);
+
+    ImageMode getImageMode() const;
+
+    /**
+     * @returns iteration count and BDD sizes of the last forward traversal
+     */
+    const ReachabilityStatistics &getStatistics() const;
+
+    /**
+     * Selects the algorithm used by isReachable() and reachableStates().
+     * The chaining engine splits the transitions into events, event k covering
+     * all transitions whose first changing state bit is k, by state bit index.
+     * Event k only rewrites bits k and after, so events are fired from the
+     * last state bit index down to the first, each until no new states are
+     * found, which for loosely coupled state machines keeps intermediate BDDs
+     * small. The events follow the state bit index rather than the current
+     * variable order, so reorderVariables() does not change them.
+     * stateDistance() and witnessTrace() always use breadth-first search, as
+     * they need the distance of each state.
+     *
+     * @param engine traversal algorithm, defaults to TraversalEngine::BreadthFirst
+     */
+    void setTraversalEngine(TraversalEngine engine);
+
+    TraversalEngine getTraversalEngine() const;
+
+    /**
+     * The transition relation is kept as a conjunction of clusters. The
+     * per-bit relations s'_i XNOR delta_i are ordered so that state and input
+     * variables can be quantified early during image computation, and are then
+     * conjoined into clusters as long as a cluster stays within the threshold.
+     * A threshold of zero keeps one cluster per state bit.
+     *
+     * @param maxNodes maximum BDD size of a cluster built from several bits
+     */
+    void setClusterThreshold(size_t maxNodes);
+
+    size_t getClusterThreshold() const;
+
+    /**
+     * @returns the clusters of the transition relation in quantification order
+     */
+    const std::vector<BDD_ID> &getTransitionClusters() const;
+
+    /**
+     * Builds the characteristic function of a single state.
+     *
+     * @param stateVector provides the assignment for each state bit
+     * @returns cube over the state variables
+     * @throws std::runtime_error if size does not match with number of state bits
+     */
+    BDD_ID stateCharFunction(const std::vector<bool> &stateVector);
+
+    /**
+     * @param stateSet characteristic function over the state variables
+     * @returns all states reachable from stateSet within one transition
+     */
+    BDD_ID image(BDD_ID stateSet);
+
+    /**
+     * @param stateSet characteristic function over the state variables
+     * @returns all states with a transition into stateSet for some input
+     */
+    BDD_ID preImage(BDD_ID stateSet);
+
+    /**
+     * Backward fixpoint from a set of target states.
+     *
+     * @param targetSet characteristic function over the state variables
+     * @returns all states from which some state of targetSet can be reached
+     */
+    BDD_ID backwardReachable(BDD_ID targetSet);
+
+    /**
+     * Decides whether some state of targetSet is reachable from the initial
+     * state. Forward and backward search are interleaved, always expanding the
+     * smaller frontier, and stop as soon as both searches meet or one of them
+     * reaches its fixpoint.
+     *
+     * @param targetSet characteristic function over the state variables
+     * @returns true, if a target state is reachable
+     */
+    bool canReach(BDD_ID targetSet);
+
+    /**
+     * Computes a shortest input sequence leading from the initial state to the
+     * given state. The trace is reconstructed backwards from the onion rings of
+     * the cached forward traversal, picking one predecessor and input valuation
+     * per step.
+     * Example: Initial state s0 = 0; s1 = 0
+     *          Transition functions: s0' = x0; s1' = s0
+     *          witnessTrace({true, true}) returns
+     *             {{False, False}, {True}}
+     *             {{True, False}, {True}}
+     *             {{True, True}, {}}
+     *
+     * @param stateVector provides the assignment for each state bit
+     * @returns stateDistance() + 1 steps starting in the initial state, empty if unreachable
+     * @throws std::runtime_error if size does not match with number of state bits
+     */
+    std::vector<TraceStep> witnessTrace(const std::vector<bool> &stateVector);
+
+    /**
+     * Checks that no state of badStates is reachable from the initial state.
+     * Each new onion ring of the breadth-first traversal is intersected with
+     * the bad states, and the traversal stops at the first ring containing one.
+     * Rings computed so far are kept, so later queries resume the traversal
+     * instead of starting over.
+     *
+     * @param badStates characteristic function over the state variables
+     * @returns whether the invariant holds, otherwise the depth of the nearest
+     *          bad state and a shortest trace leading to it
+     */
+    InvariantResult checkInvariant(BDD_ID badStates);
+
+    /**
+     * The approximate traversal splits the state bits into overlapping blocks.
+     * Starting from a state bit not covered yet, a block collects the state
+     * bits its transition function depends on, then their dependencies, until
+     * the block is full. Blocks contained in other blocks are dropped.
+     *
+     * @param maxBits maximum number of state bits per block, defaults to 8
+     * @throws std::runtime_error if maxBits is 0
+     */
+    void setApproximationBlockSize(size_t maxBits);
+
+    size_t getApproximationBlockSize() const;
+
+    /**
+     * @returns the state bit indices of each block of the approximate traversal
+     */
+    const std::vector<std::vector<size_t>> &getApproximationBlocks();
+
+    /**
+     * Over-approximates the reachable states without building the exact
+     * fixpoint. Each block is a submachine whose state bits outside the block
+     * are only constrained by the reachable sets of the other blocks. The
+     * blocks are traversed in turns until none of them grows, and the result
+     * is the conjunction of their reachable sets, which contains every
+     * reachable state.
+     *
+     * @returns BDD of a superset of the reachable states
+     */
+    BDD_ID approximateReachableStates();
+
+    /**
+     * Checks the invariant on approximateReachableStates(). If the
+     * over-approximation excludes all bad states, the invariant is proved.
+     * Otherwise the result is inconclusive, unless the set is exact because
+     * the reachable set is already known or a single block covers all state
+     * bits. Neither depth nor trace are given.
+     *
+     * @param badStates characteristic function over the state variables
+     * @returns holds if proved, otherwise conclusive is false unless the set is exact
+     */
+    InvariantResult checkInvariantApproximate(BDD_ID badStates);
+
+    /**
+     * Reorders the variables by group sifting to shrink the transition
+     * relation and the cached state sets. Every state variable s_i and its
+     * next state variable s'_i form a group, so each pair stays on adjacent
+     * levels. All BDD_IDs keep representing the same functions.
+     *
+     * @returns number of nodes of the transition relation and cached state sets
+     */
+    size_t reorderVariables();
+
 private:
     std::vector<BDD_ID> m_stateVars;
     std::vector<BDD_ID> m_nextStateVars;
     std::vector<BDD_ID> m_inputVars;
+    std::vector<size_t> m_stateBitOfVar; ///< position in m_stateVars, indexed by variable ID
     std::vector<BDD_ID> m_transitionFunctions;
     std::vector<bool> m_initState;
-    BDD_ID m_transitionRelation;
     BDD_ID m_initStateCharFunc;
 
+    /* Partitioned transition relation. */
+    std::vector<BDD_ID> m_bitRelations; ///< s'_i XNOR delta_i for every state bit i
+    std::vector<BDD_ID> m_transitionClusters;
+    std::vector<std::vector<BDD_ID>> m_clusterSupports;
+    std::vector<std::vector<size_t>> m_clusterBits; ///< state bits conjoined into each cluster
+    std::vector<size_t> m_clusterOfBit;
+    std::vector<BDD_ID> m_imageSchedule; ///< cubes to quantify before the first and after each cluster
+    std::vector<BDD_ID> m_preImageSchedule;
+    std::vector<BDD_ID> m_predecessorSchedule; ///< quantifies s' only, keeping s and the inputs
+    std::unordered_map<BDD_ID, BDD_ID> m_nextToPresent;
+    std::unordered_map<BDD_ID, BDD_ID> m_presentToNext;
+    size_t m_clusterThreshold = 2500;
+
+    /* Chaining events, built on first use. */
+    std::vector<BDD_ID> m_eventConstraints; ///< bits before k keep their value, bit k changes
+    std::vector<std::vector<BDD_ID>> m_eventSchedules;
+
+    /* Cached forward fixpoint, valid until the FSM is modified. The onion
+     * rings may hold a partial traversal, which is complete once
+     * m_reachabilityValid is set. */
+    bool m_reachableSetValid = false;
+    bool m_reachabilityValid = false;
+    BDD_ID m_reachableSet;
+    BDD_ID m_traversedSet; ///< union of the onion rings computed so far
+    std::vector<BDD_ID> m_onionRings; ///< m_onionRings[d] holds the states at distance d
+    bool m_distanceMapValid = false;
+    BDD_ID m_distanceMap; ///< ADD of the distance of each state, built from the complete onion rings
+
+    /* Cached over-approximation, valid until the FSM is modified. */
+    size_t m_approximationBlockSize = 8;
+    bool m_approximationValid = false;
+    std::vector<std::vector<size_t>> m_approximationBlocks;
+    std::vector<BDD_ID> m_blockReachableSets; ///< reachable set of each block over its own state bits
+    BDD_ID m_approximateSet;
+
+    ImageMode m_imageMode = ImageMode::Frontier;
+    TraversalEngine m_traversalEngine = TraversalEngine::BreadthFirst;
+    ReachabilityStatistics m_statistics;
+
     void computeTransitionRelation();
+    void computeSchedules();
     void computeInitStateCharFunction();
+    void computeReachability();
+    void advanceTraversal(BDD_ID stopSet);
+    int ringDistance(BDD_ID targetSet);
+    void computeDistanceMap();
+    int mappedDistance(const std::vector<bool> &stateVector);
+    void computeReachableSet();
+    void computeEvents();
+    void computeApproximationBlocks();
+    void computeApproximation();
+    void invalidateReachability();
+
+    std::vector<size_t> orderBitRelations();
+    std::vector<BDD_ID> quantificationSchedule(const std::vector<BDD_ID> &quantifyVars);
 
-    BDD_ID existQuant(BDD_ID, BDD_ID);
+    BDD_ID relationalProduct(BDD_ID set, const std::vector<BDD_ID> &schedule);
+    BDD_ID eventImage(size_t event, BDD_ID stateSet);
+    bool containsState(BDD_ID stateSet, const std::vector<bool> &stateVector);
+    bool containsPackedState(BDD_ID stateSet, const std::uint64_t *packedState);
+    std::vector<bool> cubeAssignment(BDD_ID cube, const std::vector<BDD_ID> &vars);
 };
 
 } // namespace ClassProject
@@ -166,4 +166,444 @@ TEST_F(ReachabilityTest, SetTransitionFunctionsTest)
                  std::runtime_error); // Unknown ID
 }
 
+TEST_F(ReachabilityTest, ReachableStatesTest)
+{
+    ClassProject::Reachability fsm(3);
+    const std::vector<BDD_ID> s = fsm.getStates();
+
+    // 3-bit shift register feeding in a constant one: s0' = 1, s1' = s0, s2' = s1
+    fsm.setTransitionFunctions({fsm.True(), s.at(0), s.at(1)});
+    fsm.setInitState({false, false, false});
+
+    std::vector<std::vector<bool>> states;
+    for (const Cube &minterm : fsm.minterms(fsm.reachableStates(), s))
+    {
+        std::vector<bool> state;
+        for (const auto &literal : minterm)
+            state.push_back(literal.second);
+        states.push_back(state);
+    }
+
+    const std::vector<std::vector<bool>> expected = {
+        {true, true, true},
+        {true, true, false},
+        {true, false, false},
+        {false, false, false},
+    };
+    EXPECT_EQ(states, expected);
+}
+
+TEST_F(ReachabilityTest, CachedFixpointTest)
+{
+    BDD_ID s0 = stateVars2.at(0);
+    BDD_ID s1 = stateVars2.at(1);
+
+    fsm2->setInitState({false, false});
+
+    // Default identity transitions, only the initial state is reachable.
+    EXPECT_FALSE(fsm2->isReachable({true, true}));
+    EXPECT_EQ(fsm2->stateDistance({true, true}), -1);
+
+    // Changing the transition functions must invalidate the cached result.
+    fsm2->setTransitionFunctions({fsm2->neg(s1), s0}); // s0' = !s1, s1' = s0
+    EXPECT_TRUE(fsm2->isReachable({true, true}));
+    EXPECT_EQ(fsm2->stateDistance({true, true}), 2);
+
+    // Changing the initial state must invalidate it as well.
+    fsm2->setInitState({true, true});
+    EXPECT_EQ(fsm2->stateDistance({true, true}), 0);
+    EXPECT_EQ(fsm2->stateDistance({false, false}), 2);
+
+    // Repeated queries answer from the cache.
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(fsm2->stateDistance({false, true}), 1);
+        EXPECT_EQ(fsm2->stateDistance({true, false}), 3);
+    }
+}
+
+TEST_F(ReachabilityTest, ImageModeTest)
+{
+    for (ImageMode mode : {ImageMode::ReachedSet, ImageMode::Frontier, ImageMode::FrontierRestrict})
+    {
+        ClassProject::Reachability fsm(3);
+        const std::vector<BDD_ID> s = fsm.getStates();
+
+        // 3-bit counter, every state value k is reached after k steps.
+        fsm.setTransitionFunctions({fsm.neg(s.at(0)), fsm.xor2(s.at(1), s.at(0)),
+                                    fsm.xor2(s.at(2), fsm.and2(s.at(1), s.at(0)))});
+        fsm.setImageMode(mode);
+        EXPECT_EQ(fsm.getImageMode(), mode);
+
+        for (int k = 0; k < 8; k++)
+            EXPECT_EQ(fsm.stateDistance({(k & 1) != 0, (k & 2) != 0, (k & 4) != 0}), k);
+
+        // Distance queries stop at the ring holding the state, so the last
+        // image is only computed when the fixpoint is requested.
+        EXPECT_EQ(fsm.getStatistics().iterations, 7u);
+        EXPECT_EQ(fsm.reachableStates(), fsm.True());
+
+        // One image per onion ring, the last one finds no new states.
+        const ReachabilityStatistics &stats = fsm.getStatistics();
+        EXPECT_EQ(stats.iterations, 8u);
+        EXPECT_EQ(stats.operandSizes.size(), 8u);
+        EXPECT_EQ(stats.reachedSizes.size(), 8u);
+        EXPECT_EQ(stats.reachedSizes.front(), 5u); // initial state cube
+    }
+}
+
+TEST_F(ReachabilityTest, ClusterThresholdTest)
+{
+    ClassProject::Reachability fsm(3, 1);
+    const std::vector<BDD_ID> s = fsm.getStates();
+    const BDD_ID x = fsm.getInputs().at(0);
+
+    // s0 toggles when the input is set, s1 and s2 follow as a shift register.
+    fsm.setTransitionFunctions({fsm.xor2(s.at(0), x), s.at(0), s.at(1)});
+
+    // Threshold zero keeps one cluster per state bit, a large threshold
+    // yields the monolithic relation.
+    fsm.setClusterThreshold(0);
+    EXPECT_EQ(fsm.getClusterThreshold(), 0u);
+    EXPECT_EQ(fsm.getTransitionClusters().size(), 3u);
+    const int distance = fsm.stateDistance({false, true, false});
+    EXPECT_EQ(distance, 2);
+    EXPECT_TRUE(fsm.isReachable({true, false, true}));
+
+    fsm.setClusterThreshold(1000000);
+    EXPECT_EQ(fsm.getTransitionClusters().size(), 1u);
+    fsm.setInitState({false, false, false}); // recompute with the new clusters
+    EXPECT_EQ(fsm.stateDistance({false, true, false}), distance);
+    EXPECT_TRUE(fsm.isReachable({true, false, true}));
+}
+
+TEST_F(ReachabilityTest, BackwardReachabilityTest)
+{
+    ClassProject::Reachability fsm(2, 1);
+    const std::vector<BDD_ID> s = fsm.getStates();
+    const BDD_ID x = fsm.getInputs().at(0);
+
+    // s0' = x, s1' = s0 AND s1: state {true, true} can only be entered from
+    // itself, {false, true} is a dead end unless s0 is set.
+    fsm.setTransitionFunctions({x, fsm.and2(s.at(0), s.at(1))});
+
+    const BDD_ID s00 = fsm.stateCharFunction({false, false});
+    const BDD_ID s10 = fsm.stateCharFunction({true, false});
+    const BDD_ID s11 = fsm.stateCharFunction({true, true});
+    const BDD_ID s01 = fsm.stateCharFunction({false, true});
+
+    EXPECT_EQ(fsm.image(s00), fsm.or2(s00, s10));
+    EXPECT_EQ(fsm.image(s11), fsm.or2(s11, s01));
+    EXPECT_EQ(fsm.preImage(s00), fsm.or2(fsm.or2(s00, s10), s01));
+    EXPECT_EQ(fsm.preImage(s11), s11);
+    EXPECT_EQ(fsm.preImage(fsm.False()), fsm.False());
+
+    EXPECT_EQ(fsm.backwardReachable(s01), fsm.or2(s01, s11));
+    EXPECT_EQ(fsm.backwardReachable(s10), fsm.True());
+
+    // Bidirectional search, with and without a cached forward fixpoint.
+    fsm.setInitState({false, false});
+    EXPECT_TRUE(fsm.canReach(s10));
+    EXPECT_FALSE(fsm.canReach(s11));
+    EXPECT_FALSE(fsm.canReach(fsm.or2(s01, s11)));
+    EXPECT_FALSE(fsm.isReachable({true, true}));
+    EXPECT_TRUE(fsm.canReach(fsm.or2(s00, s11)));
+    EXPECT_FALSE(fsm.canReach(s01));
+
+    fsm.setInitState({true, true});
+    EXPECT_TRUE(fsm.canReach(s01));
+    EXPECT_FALSE(fsm.canReach(fsm.False()));
+
+    EXPECT_THROW(fsm.stateCharFunction({true}), std::runtime_error);
+    EXPECT_THROW(fsm.backwardReachable(fsm.uniqueTableSize()), std::runtime_error);
+    EXPECT_THROW(fsm.canReach(fsm.uniqueTableSize()), std::runtime_error);
+}
+
+TEST_F(ReachabilityTest, WitnessTraceTest)
+{
+    ClassProject::Reachability fsm(2, 1);
+    const std::vector<BDD_ID> s = fsm.getStates();
+    const BDD_ID x = fsm.getInputs().at(0);
+
+    fsm.setTransitionFunctions({x, s.at(0)}); // s0' = x0, s1' = s0
+
+    std::vector<TraceStep> trace = fsm.witnessTrace({true, true});
+    ASSERT_EQ(trace.size(), 3u);
+    EXPECT_EQ(trace[0].state, std::vector<bool>({false, false}));
+    EXPECT_EQ(trace[0].inputs, std::vector<bool>({true}));
+    EXPECT_EQ(trace[1].state, std::vector<bool>({true, false}));
+    EXPECT_EQ(trace[1].inputs, std::vector<bool>({true}));
+    EXPECT_EQ(trace[2].state, std::vector<bool>({true, true}));
+    EXPECT_TRUE(trace[2].inputs.empty());
+
+    trace = fsm.witnessTrace({false, true});
+    ASSERT_EQ(trace.size(), 3u);
+    EXPECT_EQ(trace[1].inputs, std::vector<bool>({false}));
+
+    // The initial state is its own trace.
+    trace = fsm.witnessTrace({false, false});
+    ASSERT_EQ(trace.size(), 1u);
+    EXPECT_EQ(trace[0].state, std::vector<bool>({false, false}));
+
+    // Unreachable states have no trace.
+    fsm.setTransitionFunctions({fsm.and2(x, s.at(1)), s.at(0)}); // s0' = x0 AND s1
+    EXPECT_TRUE(fsm.witnessTrace({true, true}).empty());
+
+    EXPECT_THROW(fsm.witnessTrace({true}), std::runtime_error);
+}
+
+TEST_F(ReachabilityTest, ChainingEngineTest)
+{
+    ClassProject::Reachability fsm(4, 1);
+    const std::vector<BDD_ID> s = fsm.getStates();
+    const BDD_ID x = fsm.getInputs().at(0);
+
+    // Two loosely coupled 2-bit machines: a counter enabled by the input and
+    // a shift register sampling the counter's upper bit.
+    fsm.setTransitionFunctions({fsm.xor2(s.at(0), fsm.and2(s.at(1), x)), fsm.xor2(s.at(1), x),
+                                s.at(0), s.at(2)});
+    fsm.setInitState({false, false, false, false});
+
+    EXPECT_EQ(fsm.getTraversalEngine(), TraversalEngine::BreadthFirst);
+    const BDD_ID bfsReachable = fsm.reachableStates();
+
+    fsm.setTraversalEngine(TraversalEngine::Chaining);
+    EXPECT_EQ(fsm.getTraversalEngine(), TraversalEngine::Chaining);
+    fsm.setInitState({false, false, false, false}); // drop the cached result
+    EXPECT_EQ(fsm.reachableStates(), bfsReachable);
+    EXPECT_GT(fsm.getStatistics().iterations, 0u);
+
+    // The distances still come from BFS.
+    EXPECT_TRUE(fsm.isReachable({true, false, true, true}));
+    EXPECT_FALSE(fsm.isReachable({false, true, true, false}));
+    EXPECT_EQ(fsm.stateDistance({false, false, false, false}), 0);
+    EXPECT_EQ(fsm.stateDistance({false, true, false, false}), 1);
+}
+
+TEST_F(ReachabilityTest, CheckInvariantTest)
+{
+    ClassProject::Reachability fsm(3, 1);
+    const std::vector<BDD_ID> s = fsm.getStates();
+    const BDD_ID x = fsm.getInputs().at(0);
+
+    // Shift register: the all-ones state is three steps away.
+    fsm.setTransitionFunctions({x, s.at(0), s.at(1)});
+    fsm.setInitState({false, false, false});
+
+    const BDD_ID allOnes = fsm.and2(s.at(0), fsm.and2(s.at(1), s.at(2)));
+    InvariantResult result = fsm.checkInvariant(allOnes);
+
+    EXPECT_FALSE(result.holds);
+    EXPECT_EQ(result.depth, 3);
+    ASSERT_EQ(result.trace.size(), 4u);
+    EXPECT_EQ(result.trace.front().state, std::vector<bool>({false, false, false}));
+    EXPECT_EQ(result.trace.back().state, std::vector<bool>({true, true, true}));
+
+    // The traversal stopped at the ring holding the bad state, before the
+    // fixpoint check, and is resumed by the next query.
+    EXPECT_EQ(fsm.getStatistics().iterations, 3u);
+    EXPECT_EQ(fsm.stateDistance({true, true, true}), 3);
+    EXPECT_EQ(fsm.reachableStates(), fsm.True());
+    EXPECT_EQ(fsm.getStatistics().iterations, 4u);
+
+    // s1 can only be set together with s0, so s1 AND NOT s0 is never reached.
+    fsm.setTransitionFunctions({x, fsm.and2(s.at(0), x), s.at(2)});
+    result = fsm.checkInvariant(fsm.and2(s.at(1), fsm.neg(s.at(0))));
+
+    EXPECT_TRUE(result.holds);
+    EXPECT_EQ(result.depth, -1);
+    EXPECT_TRUE(result.trace.empty());
+
+    EXPECT_THROW(fsm.checkInvariant(fsm.uniqueTableSize() + 1), std::runtime_error);
+}
+
+TEST_F(ReachabilityTest, IsReachableBatchTest)
+{
+    ClassProject::Reachability fsm(3, 1);
+    const std::vector<BDD_ID> s = fsm.getStates();
+    const BDD_ID x = fsm.getInputs().at(0);
+
+    // s1 can only be set together with s0, s2 keeps its initial value.
+    fsm.setTransitionFunctions({x, fsm.and2(s.at(0), x), s.at(2)});
+    fsm.setInitState({false, false, false});
+
+    std::vector<std::vector<bool>> states;
+    std::vector<std::uint64_t> packed;
+    for (unsigned int k = 0; k < 8; k++)
+    {
+        states.push_back({(k & 1) != 0, (k & 2) != 0, (k & 4) != 0});
+        packed.push_back(k);
+    }
+
+    const std::vector<bool> expected = {true, true, false, true, false, false, false, false};
+    EXPECT_EQ(fsm.packedStateWords(), 1u);
+    EXPECT_EQ(fsm.isReachableBatch(states), expected);
+    EXPECT_EQ(fsm.isReachableBatch(states, 3), expected);
+    EXPECT_EQ(fsm.isReachableBatch(packed), expected);
+    EXPECT_EQ(fsm.isReachableBatch(packed, 16), expected);
+    EXPECT_TRUE(fsm.isReachableBatch(std::vector<std::vector<bool>>()).empty());
+
+    states.push_back({true});
+    EXPECT_THROW(fsm.isReachableBatch(states), std::runtime_error);
+
+    // States wider than one word.
+    ClassProject::Reachability wide(70);
+    ASSERT_EQ(wide.packedStateWords(), 2u);
+    EXPECT_EQ(wide.isReachableBatch(std::vector<std::uint64_t>({0, 0, 0, 1u << 5}), 2),
+              std::vector<bool>({true, false}));
+    EXPECT_THROW(wide.isReachableBatch(std::vector<std::uint64_t>({0, 0, 0})), std::runtime_error);
+}
+
+TEST_F(ReachabilityTest, UpdateTransitionFunctionTest)
+{
+    ClassProject::Reachability fsm(3, 1);
+    const std::vector<BDD_ID> s = fsm.getStates();
+    const BDD_ID x = fsm.getInputs().at(0);
+
+    fsm.setClusterThreshold(0);
+    fsm.setTransitionFunctions({x, fsm.and2(s.at(0), x), s.at(2)});
+    fsm.setInitState({false, false, false});
+    const BDD_ID reachable = fsm.reachableStates();
+    EXPECT_FALSE(fsm.isReachable({false, true, false}));
+
+    // s2 stays false on all reachable states, so the result is unchanged.
+    fsm.updateTransitionFunction(2, fsm.and2(s.at(2), s.at(1)));
+    EXPECT_EQ(fsm.reachableStates(), reachable);
+
+    // Now s2 toggles and s1 is set from s2.
+    fsm.updateTransitionFunctions({{1, s.at(2)}, {2, fsm.neg(s.at(2))}});
+    EXPECT_TRUE(fsm.isReachable({false, true, false}));
+    EXPECT_EQ(fsm.stateDistance({false, true, false}), 2);
+    EXPECT_EQ(fsm.stateDistance({true, true, false}), 2);
+
+    // The rebuilt clusters still conjoin to the whole transition relation,
+    // with s'_i at ID s_i + 1.
+    BDD_ID relation = fsm.True();
+    for (BDD_ID cluster : fsm.getTransitionClusters())
+        relation = fsm.and2(relation, cluster);
+
+    const std::vector<BDD_ID> functions = {x, s.at(2), fsm.neg(s.at(2))};
+    BDD_ID expected = fsm.True();
+    for (size_t i = 0; i < 3; i++)
+        expected = fsm.and2(expected, fsm.xnor2(s.at(i) + 1, functions.at(i)));
+    EXPECT_EQ(relation, expected);
+
+    EXPECT_THROW(fsm.updateTransitionFunction(3, x), std::runtime_error);
+    EXPECT_THROW(fsm.updateTransitionFunction(0, fsm.uniqueTableSize()), std::runtime_error);
+}
+
+TEST_F(ReachabilityTest, ApproximateReachabilityTest)
+{
+    ClassProject::Reachability fsm(3, 1);
+    const std::vector<BDD_ID> s = fsm.getStates();
+    const BDD_ID x = fsm.getInputs().at(0);
+
+    // s1 can only be set together with s0, s2 keeps its initial value.
+    fsm.setTransitionFunctions({x, fsm.and2(s.at(0), x), s.at(2)});
+    fsm.setInitState({false, false, false});
+
+    // With single-bit blocks, s1 is seen without the constraint from s0.
+    EXPECT_EQ(fsm.getApproximationBlockSize(), 8u);
+    fsm.setApproximationBlockSize(1);
+    EXPECT_EQ(fsm.getApproximationBlocks(),
+              std::vector<std::vector<size_t>>({{0}, {1}, {2}}));
+    EXPECT_EQ(fsm.approximateReachableStates(), fsm.neg(s.at(2)));
+
+    const InvariantResult proved = fsm.checkInvariantApproximate(s.at(2));
+    EXPECT_TRUE(proved.holds);
+    EXPECT_TRUE(proved.conclusive);
+
+    const BDD_ID s1WithoutS0 = fsm.and2(s.at(1), fsm.neg(s.at(0)));
+    const InvariantResult unknown = fsm.checkInvariantApproximate(s1WithoutS0);
+    EXPECT_FALSE(unknown.holds);
+    EXPECT_FALSE(unknown.conclusive);
+    EXPECT_TRUE(fsm.checkInvariant(s1WithoutS0).holds);
+
+    // The exact reachable set is known now, so a hit is a violation.
+    const InvariantResult violated = fsm.checkInvariantApproximate(s.at(0));
+    EXPECT_FALSE(violated.holds);
+    EXPECT_TRUE(violated.conclusive);
+
+    // Bit 1 and its fanin form one block, which also covers bit 0.
+    fsm.setApproximationBlockSize(2);
+    EXPECT_EQ(fsm.getApproximationBlocks(), std::vector<std::vector<size_t>>({{0, 1}, {2}}));
+    fsm.setInitState({false, false, false}); // drop the exact result
+    EXPECT_EQ(fsm.approximateReachableStates(), fsm.and2(fsm.neg(s.at(2)), fsm.neg(s1WithoutS0)));
+    EXPECT_TRUE(fsm.checkInvariantApproximate(s1WithoutS0).holds);
+
+    EXPECT_THROW(fsm.setApproximationBlockSize(0), std::runtime_error);
+
+    // s1' = s0 makes {0} part of the block {0, 1}, which covers all bits.
+    ClassProject::Reachability shift(2, 1);
+    const std::vector<BDD_ID> t = shift.getStates();
+    shift.setTransitionFunctions({shift.getInputs().at(0), t.at(0)});
+    shift.setInitState({false, false});
+    EXPECT_EQ(shift.getApproximationBlocks(), std::vector<std::vector<size_t>>({{0, 1}}));
+
+    const InvariantResult exact = shift.checkInvariantApproximate(shift.and2(t.at(0), t.at(1)));
+    EXPECT_FALSE(exact.holds);
+    EXPECT_TRUE(exact.conclusive);
+}
+
+TEST_F(ReachabilityTest, DistanceMapTest)
+{
+    ClassProject::Reachability fsm(3);
+    const std::vector<BDD_ID> s = fsm.getStates();
+
+    // 3-bit counter up to 5, which wraps around to 0.
+    const BDD_ID atFive = fsm.and2(s.at(0), fsm.and2(fsm.neg(s.at(1)), s.at(2)));
+    fsm.setTransitionFunctions({fsm.and2(fsm.neg(s.at(0)), fsm.neg(atFive)),
+                                fsm.and2(fsm.xor2(s.at(1), s.at(0)), fsm.neg(atFive)),
+                                fsm.and2(fsm.xor2(s.at(2), fsm.and2(s.at(1), s.at(0))), fsm.neg(atFive))});
+
+    std::vector<std::vector<bool>> states;
+    for (int k = 0; k < 8; k++)
+        states.push_back({(k & 1) != 0, (k & 2) != 0, (k & 4) != 0});
+
+    const std::vector<int> expected = {0, 1, 2, 3, 4, 5, -1, -1};
+    EXPECT_EQ(fsm.stateDistances(states), expected);
+    EXPECT_EQ(fsm.stateDistances(states, 4), expected);
+
+    const BDD_ID distances = fsm.distanceMap();
+    EXPECT_EQ(fsm.addValue(fsm.coFactorTrue(fsm.coFactorTrue(distances, s.at(1)), s.at(2))), -1);
+
+    for (int k = 0; k < 8; k++)
+        EXPECT_EQ(fsm.stateDistance(states.at(k)), expected.at(k));
+
+    // The map is rebuilt when the FSM changes.
+    fsm.setInitState({false, false, true});
+    EXPECT_EQ(fsm.stateDistances({{false, false, true}, {true, false, true}, {false, false, false}}),
+              std::vector<int>({0, 1, 2}));
+
+    states.push_back({true});
+    EXPECT_THROW(fsm.stateDistances(states), std::runtime_error);
+}
+
+
+TEST_F(ReachabilityTest, ReorderVariablesTest)
+{
+    ClassProject::Reachability fsm(4, 1);
+    const std::vector<BDD_ID> s = fsm.getStates();
+    const BDD_ID x = fsm.getInputs().at(0);
+
+    // Shift register feeding x into s0.
+    fsm.setTransitionFunctions({x, s.at(0), s.at(1), s.at(2)});
+    fsm.setInitState({false, false, false, false});
+    const BDD_ID reachable = fsm.reachableStates();
+    EXPECT_EQ(fsm.stateDistance({true, true, true, true}), 4);
+
+    fsm.reorderVariables();
+
+    // Every state variable is still directly followed by its next state variable.
+    for (BDD_ID var : s)
+        EXPECT_EQ(fsm.getVarAtLevel(fsm.getLevel(var) + 1), var + 1);
+
+    EXPECT_EQ(fsm.reachableStates(), reachable);
+    EXPECT_EQ(fsm.stateDistance({true, true, true, true}), 4);
+    EXPECT_EQ(fsm.stateDistance({false, true, false, false}), 2);
+    EXPECT_EQ(fsm.image(fsm.stateCharFunction({false, false, false, true})),
+              fsm.or2(fsm.stateCharFunction({false, false, false, false}),
+                      fsm.stateCharFunction({true, false, false, false})));
+}
+
 #endif
@@ -10,6 +10,8 @@
 #include <fstream>
 
 using ClassProject::BDD_ID;
+using ClassProject::Cube;
+using ClassProject::CubeRange;
 
 class ManagerTest : public ::testing::Test
 {
@@ -526,4 +528,409 @@ TEST_F(ManagerTest, VisualizeBDD)
     EXPECT_TRUE(file.is_open());
 }
 
+// Manager::pickOneCube() test
+TEST_F(ManagerTest, PickOneCube)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+    const BDD_ID c_id = manager.createVar("c");
+
+    // Constants and cubes are their own cube.
+    EXPECT_EQ(manager.pickOneCube(FALSE_ID), FALSE_ID);
+    EXPECT_EQ(manager.pickOneCube(TRUE_ID), TRUE_ID);
+    EXPECT_EQ(manager.pickOneCube(a_id), a_id);
+
+    const BDD_ID a_and_not_b_id = manager.and2(a_id, manager.neg(b_id));
+    EXPECT_EQ(manager.pickOneCube(a_and_not_b_id), a_and_not_b_id);
+
+    // The cube must imply the function.
+    const BDD_ID f_id = manager.or2(manager.and2(manager.neg(a_id), b_id), c_id);
+    const BDD_ID cube_id = manager.pickOneCube(f_id);
+    EXPECT_NE(cube_id, FALSE_ID);
+    EXPECT_EQ(manager.and2(cube_id, f_id), cube_id);
+}
+
+// Manager::cubes() test
+TEST_F(ManagerTest, Cubes)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+    const BDD_ID c_id = manager.createVar("c");
+    const BDD_ID f_id = manager.or2(manager.and2(a_id, b_id), c_id);
+
+    // The paths of f to True: a b, a !b c, !a c.
+    std::vector<Cube> expected = {
+        {{a_id, true}, {b_id, true}},
+        {{a_id, true}, {b_id, false}, {c_id, true}},
+        {{a_id, false}, {c_id, true}},
+    };
+    std::vector<Cube> found;
+    for (const Cube &cube : manager.cubes(f_id))
+        found.push_back(cube);
+
+    EXPECT_EQ(found, expected);
+
+    // Constants yield no cube or the empty cube.
+    EXPECT_EQ(manager.cubes(FALSE_ID).begin(), manager.cubes(FALSE_ID).end());
+    CubeRange true_range = manager.cubes(TRUE_ID);
+    auto it = true_range.begin();
+    EXPECT_TRUE(it->empty());
+    EXPECT_EQ(++it, true_range.end());
+}
+
+// Manager::minterms() test
+TEST_F(ManagerTest, Minterms)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+    const BDD_ID c_id = manager.createVar("c");
+    const BDD_ID a_or_c_id = manager.or2(a_id, c_id);
+
+    // Don't-care variables are expanded, variables are listed in order.
+    size_t count = 0;
+    for (const Cube &minterm : manager.minterms(a_or_c_id, {c_id, b_id, a_id}))
+    {
+        ASSERT_EQ(minterm.size(), 3u);
+        EXPECT_EQ(minterm[0].first, a_id);
+        EXPECT_EQ(minterm[1].first, b_id);
+        EXPECT_EQ(minterm[2].first, c_id);
+        EXPECT_TRUE(minterm[0].second || minterm[2].second);
+        count++;
+    }
+    EXPECT_EQ(count, 6u);
+
+    count = 0;
+    for (const Cube &minterm : manager.minterms(TRUE_ID, {a_id, b_id}))
+        count += minterm.size();
+    EXPECT_EQ(count, 8u);
+
+    // The function must not depend on variables outside the list.
+    EXPECT_THROW(
+        {
+            for (const Cube &minterm : manager.minterms(a_or_c_id, {a_id, b_id}))
+                (void)minterm;
+        },
+        std::runtime_error);
+}
+
+// Manager::restrict() test
+TEST_F(ManagerTest, Restrict)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+    const BDD_ID c_id = manager.createVar("c");
+    const BDD_ID f_id = manager.or2(manager.and2(a_id, b_id), c_id);
+
+    // Trivial care sets.
+    EXPECT_EQ(manager.restrict(f_id, TRUE_ID), f_id);
+    EXPECT_EQ(manager.restrict(f_id, f_id), TRUE_ID);
+    EXPECT_EQ(manager.restrict(TRUE_ID, a_id), TRUE_ID);
+
+    // Care set is a cube, restrict equals the cofactor.
+    EXPECT_EQ(manager.restrict(f_id, a_id), manager.or2(b_id, c_id));
+    EXPECT_EQ(manager.restrict(f_id, manager.neg(c_id)), manager.and2(a_id, b_id));
+
+    // The result agrees with f on the care set.
+    const BDD_ID care_id = manager.xor2(a_id, c_id);
+    const BDD_ID restricted_id = manager.restrict(f_id, care_id);
+    EXPECT_EQ(manager.and2(restricted_id, care_id), manager.and2(f_id, care_id));
+}
+
+// Manager::nodeCount() test
+TEST_F(ManagerTest, NodeCount)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+
+    EXPECT_EQ(manager.nodeCount(TRUE_ID), 1u);
+    EXPECT_EQ(manager.nodeCount(a_id), 3u);
+    EXPECT_EQ(manager.nodeCount(manager.and2(a_id, b_id)), 4u);
+    EXPECT_EQ(manager.nodeCount(manager.xor2(a_id, b_id)), 5u);
+}
+
+// Manager::exists() and Manager::andExists() test
+TEST_F(ManagerTest, Exists)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+    const BDD_ID c_id = manager.createVar("c");
+    const BDD_ID f_id = manager.and2(manager.xor2(a_id, b_id), c_id);
+
+    // Cube of variables, order of the arguments does not matter.
+    const BDD_ID ab_id = manager.makeCube({b_id, a_id});
+    EXPECT_EQ(ab_id, manager.and2(a_id, b_id));
+    EXPECT_EQ(manager.makeCube({}), TRUE_ID);
+    EXPECT_EQ(manager.support(f_id), std::vector<BDD_ID>({a_id, b_id, c_id}));
+
+    EXPECT_EQ(manager.exists(f_id, TRUE_ID), f_id);
+    EXPECT_EQ(manager.exists(f_id, a_id), c_id);
+    EXPECT_EQ(manager.exists(f_id, ab_id), c_id);
+    EXPECT_EQ(manager.exists(f_id, c_id), manager.xor2(a_id, b_id));
+    EXPECT_EQ(manager.exists(f_id, manager.makeCube({a_id, b_id, c_id})), TRUE_ID);
+    EXPECT_EQ(manager.exists(manager.and2(a_id, manager.neg(a_id)), a_id), FALSE_ID);
+
+    // Relational product equals quantifying the conjunction.
+    const BDD_ID g_id = manager.or2(manager.neg(a_id), c_id);
+    EXPECT_EQ(manager.andExists(f_id, g_id, ab_id), manager.exists(manager.and2(f_id, g_id), ab_id));
+    EXPECT_EQ(manager.andExists(f_id, manager.neg(c_id), a_id), FALSE_ID);
+    EXPECT_EQ(manager.andExists(f_id, TRUE_ID, TRUE_ID), f_id);
+}
+
+// Manager::rename() test
+TEST_F(ManagerTest, Rename)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+    const BDD_ID c_id = manager.createVar("c");
+    const BDD_ID d_id = manager.createVar("d");
+
+    const BDD_ID f_id = manager.or2(manager.and2(a_id, b_id), manager.neg(c_id));
+    EXPECT_EQ(manager.rename(f_id, {{b_id, d_id}}),
+              manager.or2(manager.and2(a_id, d_id), manager.neg(c_id)));
+
+    // Swapping variables also works against the variable order.
+    EXPECT_EQ(manager.rename(manager.and2(a_id, manager.neg(d_id)), {{a_id, d_id}, {d_id, a_id}}),
+              manager.and2(d_id, manager.neg(a_id)));
+    EXPECT_EQ(manager.rename(TRUE_ID, {{a_id, b_id}}), TRUE_ID);
+}
+
+// Manager::evaluate() test
+TEST_F(ManagerTest, Evaluate)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+    const BDD_ID c_id = manager.createVar("c");
+    const BDD_ID f_id = manager.or2(manager.and2(a_id, b_id), c_id);
+    const size_t table_size = manager.uniqueTableSize();
+
+    // Assignment k sets a, b and c to bits 0, 1 and 2 of k.
+    std::vector<uint64_t> parallel(c_id + 1, 0);
+    uint64_t expected_parallel = 0;
+
+    for (unsigned int k = 0; k < 8; k++)
+    {
+        const bool a = k & 1, b = k & 2, c = k & 4;
+        const bool expected = (a && b) || c;
+
+        std::vector<bool> assignment(c_id + 1, false);
+        assignment[a_id] = a;
+        assignment[b_id] = b;
+        assignment[c_id] = c;
+        EXPECT_EQ(manager.evaluate(f_id, assignment), expected);
+
+        const uint64_t packed = (uint64_t(a) << a_id) | (uint64_t(b) << b_id) | (uint64_t(c) << c_id);
+        EXPECT_EQ(manager.evaluate(f_id, std::vector<uint64_t>({packed})), expected);
+
+        parallel[a_id] |= uint64_t(a) << k;
+        parallel[b_id] |= uint64_t(b) << k;
+        parallel[c_id] |= uint64_t(c) << k;
+        expected_parallel |= uint64_t(expected) << k;
+    }
+
+    EXPECT_EQ(manager.evaluate64(f_id, parallel) & 0xFF, expected_parallel);
+    EXPECT_EQ(manager.evaluate64(TRUE_ID, {}), ~uint64_t(0));
+    EXPECT_TRUE(manager.evaluate(TRUE_ID, std::vector<bool>()));
+
+    // Evaluation does not create nodes.
+    EXPECT_EQ(manager.uniqueTableSize(), table_size);
+
+    EXPECT_THROW(manager.evaluate(f_id, std::vector<bool>(b_id, true)), std::runtime_error);
+    EXPECT_THROW(manager.evaluate64(f_id, std::vector<uint64_t>(b_id)), std::runtime_error);
+
+    // Later calls are not affected by earlier ones, including nodes created in between.
+    EXPECT_EQ(manager.evaluate64(f_id, parallel) & 0xFF, expected_parallel);
+    const BDD_ID g_id = manager.xor2(a_id, c_id);
+    EXPECT_EQ(manager.evaluate64(g_id, parallel) & 0xFF, 0x5Au);
+}
+
+// Manager::addConst() and Manager::addValue() test
+TEST_F(ManagerTest, AddConst)
+{
+    const BDD_ID a_id = manager.createVar("a");
+
+    // 0 and 1 are the BDD terminals.
+    EXPECT_EQ(manager.addConst(0), FALSE_ID);
+    EXPECT_EQ(manager.addConst(1), TRUE_ID);
+
+    const BDD_ID five_id = manager.addConst(5);
+    EXPECT_EQ(manager.addConst(5), five_id);
+    EXPECT_TRUE(manager.isConstant(five_id));
+    EXPECT_FALSE(manager.isVariable(five_id));
+    EXPECT_EQ(manager.addValue(five_id), 5);
+    EXPECT_EQ(manager.addValue(TRUE_ID), 1);
+    EXPECT_THROW(manager.addValue(a_id), std::runtime_error);
+
+    // ite() selects between ADDs.
+    const BDD_ID f_id = manager.ite(a_id, five_id, manager.addConst(-1));
+    EXPECT_EQ(manager.topVar(f_id), a_id);
+    EXPECT_EQ(manager.coFactorTrue(f_id), five_id);
+    EXPECT_EQ(manager.addValue(manager.coFactorFalse(f_id)), -1);
+    EXPECT_EQ(manager.ite(a_id, five_id, five_id), five_id);
+    EXPECT_EQ(manager.nodeCount(f_id), 3u);
+}
+
+// Manager::addApply() test
+TEST_F(ManagerTest, AddApply)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+
+    const BDD_ID f_id = manager.ite(a_id, manager.addConst(2), manager.addConst(3));
+    const BDD_ID g_id = manager.ite(b_id, manager.addConst(10), FALSE_ID);
+
+    // Sum over all four assignments of a and b.
+    const BDD_ID sum_id = manager.addApply(f_id, g_id, ClassProject::AddOperation::Plus);
+    auto value = [&](BDD_ID add, bool a, bool b)
+    {
+        return manager.addValue(manager.followPath(add, [&](BDD_ID var) { return var == a_id ? a : b; }));
+    };
+    EXPECT_EQ(value(sum_id, true, true), 12);
+    EXPECT_EQ(value(sum_id, true, false), 2);
+    EXPECT_EQ(value(sum_id, false, true), 13);
+    EXPECT_EQ(value(sum_id, false, false), 3);
+
+    // A 0/1 ADD is a BDD, multiplying with it masks the other ADD.
+    EXPECT_EQ(manager.addApply(f_id, b_id, ClassProject::AddOperation::Times),
+              manager.ite(b_id, f_id, FALSE_ID));
+    EXPECT_EQ(manager.addApply(f_id, manager.addConst(2.5), ClassProject::AddOperation::Minimum),
+              manager.ite(a_id, manager.addConst(2), manager.addConst(2.5)));
+    EXPECT_EQ(manager.addApply(f_id, f_id, ClassProject::AddOperation::Maximum), f_id);
+}
+
+
+// Manager::swapLevels() test
+TEST_F(ManagerTest, SwapLevels)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+    const BDD_ID c_id = manager.createVar("c");
+    const BDD_ID f_id = manager.or2(manager.and2(a_id, b_id), c_id);
+    const BDD_ID g_id = manager.xor2(a_id, c_id);
+
+    EXPECT_EQ(manager.getLevel(a_id), 0u);
+    EXPECT_EQ(manager.getVarAtLevel(2), c_id);
+
+    manager.swapLevels(0);
+    manager.swapLevels(1);
+    EXPECT_EQ(manager.getVarAtLevel(0), b_id);
+    EXPECT_EQ(manager.getVarAtLevel(1), c_id);
+    EXPECT_EQ(manager.getLevel(a_id), 2u);
+    EXPECT_EQ(manager.topVar(f_id), b_id);
+    EXPECT_EQ(manager.topVar(g_id), c_id);
+
+    // The IDs keep their functions, and new results reuse them.
+    for (unsigned int k = 0; k < 8; k++)
+    {
+        std::vector<bool> assignment(c_id + 1, false);
+        assignment[a_id] = k & 1;
+        assignment[b_id] = k & 2;
+        assignment[c_id] = k & 4;
+        EXPECT_EQ(manager.evaluate(f_id, assignment), ((k & 1) && (k & 2)) || (k & 4));
+        EXPECT_EQ(manager.evaluate(g_id, assignment), bool(k & 1) != bool(k & 4));
+    }
+    EXPECT_EQ(manager.or2(c_id, manager.and2(b_id, a_id)), f_id);
+    EXPECT_EQ(manager.coFactorFalse(f_id, c_id), manager.and2(a_id, b_id));
+    EXPECT_EQ(manager.support(f_id), std::vector<BDD_ID>({b_id, c_id, a_id}));
+
+    // Grouped variables can only move together.
+    manager.groupVariables({c_id, a_id});
+    EXPECT_THROW(manager.swapLevels(1), std::runtime_error);
+    EXPECT_THROW(manager.swapLevels(0), std::runtime_error);
+    EXPECT_THROW(manager.groupVariables({b_id, c_id}), std::runtime_error);
+    EXPECT_THROW(manager.groupVariables({b_id, a_id}), std::runtime_error);
+    EXPECT_THROW(manager.swapLevels(2), std::runtime_error);
+    EXPECT_THROW(manager.getLevel(f_id), std::runtime_error);
+}
+
+// Manager::reorder() test
+TEST_F(ManagerTest, Reorder)
+{
+    // a0 b0 + a1 b1 + a2 b2 is exponential in the order a0 a1 a2 b0 b1 b2.
+    std::vector<BDD_ID> a, b;
+    for (int i = 0; i < 3; i++)
+        a.push_back(manager.createVar("a" + std::to_string(i)));
+    for (int i = 0; i < 3; i++)
+        b.push_back(manager.createVar("b" + std::to_string(i)));
+
+    BDD_ID f_id = FALSE_ID;
+    for (int i = 0; i < 3; i++)
+        f_id = manager.or2(f_id, manager.and2(a.at(i), b.at(i)));
+    const BDD_ID g_id = manager.and2(a.at(0), b.at(2));
+    EXPECT_EQ(manager.nodeCount(f_id), 16u);
+
+    manager.groupVariables({a.at(1), a.at(2)});
+    const size_t size = manager.reorder({f_id, g_id});
+    EXPECT_LT(size, 14u);
+    EXPECT_EQ(manager.getLevel(a.at(2)), manager.getLevel(a.at(1)) + 1);
+
+    for (unsigned int k = 0; k < 64; k++)
+    {
+        std::vector<bool> assignment(b.back() + 1, false);
+        bool expected = false;
+        for (int i = 0; i < 3; i++)
+        {
+            assignment[a.at(i)] = k & (1 << i);
+            assignment[b.at(i)] = k & (8 << i);
+            expected = expected || (assignment[a.at(i)] && assignment[b.at(i)]);
+        }
+        EXPECT_EQ(manager.evaluate(f_id, assignment), expected);
+        EXPECT_EQ(manager.evaluate(g_id, assignment), assignment[a.at(0)] && assignment[b.at(2)]);
+    }
+
+    BDD_ID rebuilt = FALSE_ID;
+    for (int i = 2; i >= 0; i--)
+        rebuilt = manager.or2(manager.and2(b.at(i), a.at(i)), rebuilt);
+    EXPECT_EQ(rebuilt, f_id);
+}
+
+// Manager::collectGarbage() test
+TEST_F(ManagerTest, CollectGarbage)
+{
+    const BDD_ID a_id = manager.createVar("a");
+    const BDD_ID b_id = manager.createVar("b");
+    const BDD_ID c_id = manager.createVar("c");
+    const BDD_ID f_id = manager.or2(manager.and2(a_id, b_id), c_id);
+    manager.xor2(a_id, c_id);
+    const BDD_ID h_id = manager.addConst(2.5);
+    const size_t table_size = manager.uniqueTableSize();
+    EXPECT_EQ(manager.liveNodeCount(), table_size);
+
+    // Only f, the variables, the constants and the ADD terminal survive.
+    const size_t freed = manager.collectGarbage({f_id});
+    EXPECT_EQ(freed, table_size - manager.nodeCount(f_id) - 3);
+    EXPECT_EQ(manager.liveNodeCount(), table_size - freed);
+    EXPECT_EQ(manager.uniqueTableSize(), table_size);
+    EXPECT_EQ(manager.addValue(h_id), 2.5);
+    EXPECT_EQ(manager.topVar(b_id), b_id);
+
+    // f keeps its ID, and new results reuse its nodes.
+    EXPECT_EQ(manager.or2(c_id, manager.and2(b_id, a_id)), f_id);
+
+    // Freed IDs are reused before the table grows.
+    const BDD_ID xor_id = manager.xor2(a_id, c_id);
+    EXPECT_LT(xor_id, table_size);
+    EXPECT_EQ(manager.uniqueTableSize(), table_size);
+
+    for (unsigned int k = 0; k < 8; k++)
+    {
+        std::vector<bool> assignment(c_id + 1, false);
+        assignment[a_id] = k & 1;
+        assignment[b_id] = k & 2;
+        assignment[c_id] = k & 4;
+        EXPECT_EQ(manager.evaluate(f_id, assignment), ((k & 1) && (k & 2)) || (k & 4));
+        EXPECT_EQ(manager.evaluate(xor_id, assignment), bool(k & 1) != bool(k & 4));
+    }
+
+    // Reordering skips the freed nodes.
+    manager.swapLevels(0);
+    EXPECT_EQ(manager.topVar(f_id), b_id);
+    EXPECT_EQ(manager.and2(manager.or2(a_id, c_id), manager.or2(b_id, c_id)), f_id);
+
+    EXPECT_THROW(manager.collectGarbage({manager.uniqueTableSize()}), std::runtime_error);
+
+    // The swap and the intermediate results left unreachable nodes.
+    EXPECT_GT(manager.collectGarbage({f_id, xor_id}), 0u);
+    EXPECT_EQ(manager.collectGarbage({f_id, xor_id}), 0u);
+}
+
 #endif